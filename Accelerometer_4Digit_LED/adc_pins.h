@@ -0,0 +1,29 @@
+/*
+ *  adc_pins.h
+ *  ADC10 channels of the accelerometer display
+ *  Used by Common/adc_sampler.c
+ */
+
+#ifndef ADC_PINS_H_
+#define ADC_PINS_H_
+
+// channels A0 up to this one are converted in every sequence
+#define ADC_HIGHEST_CHANNEL 2
+
+// pins of port 1 used as analog inputs, the x, y and z outputs
+#define ADC_INPUTS (BIT0 | BIT1 | BIT2) // p1.0, p1.1, p1.2
+
+// Timer_A starting the conversions, 0 for Timer0_A or 1 for Timer1_A
+#define ADC_TRIGGER_TIMER 0 // Timer1_A refreshes the display
+// sequences per second, 100 to 2000, one conversion every ms for the state
+// machine tick of main.c
+#define ADC_SAMPLE_RATE 333
+// 4^2 sequences summed into each 12 bit sample, about 21 samples a second
+#define ADC_OVERSAMPLE_BITS 2
+
+// clock the samples are timestamped with, counted by the Timer0_A interrupt in
+// main.c so this is in ms
+extern volatile unsigned int milliseconds;
+#define ADC_TIME milliseconds
+
+#endif /* ADC_PINS_H_ */
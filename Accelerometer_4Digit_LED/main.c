@@ -1,51 +1,66 @@
 #include <msp430.h>
 #include <stdbool.h>
+#include "../Common/quad_led.h"
+#include "../Common/adc_sampler.h"
+#include "../Common/filters.h"
+#include "../Common/info_flash.h"
 
-// PORT2 pins for turning on LED digits
-#define DIGIT_1 BIT3  //p2.3
-#define DIGIT_2 BIT2  //p2.2
-#define DIGIT_3 BIT1  //p2.1
-#define DIGIT_4 BIT0  //p2.0
+// ADC channels of the axes, the pins are in adc_pins.h
+#define ADC_CHANNEL_X 0 //p1.0 for ADC
+#define ADC_CHANNEL_Y 1 //p1.1 for ADC
+#define ADC_CHANNEL_Z 2 //p1.2 for ADC
 
-// 7 segments B-F of LED connected to pins of port1 and  A to port2
-#define a BIT4    //p2.4
-#define b BIT5    //p1.5
-#define c BIT6    //p2.6
-#define d BIT7    //p2.7
-#define e BIT7    //p1.7
-#define f BIT6    //p1.6
-#define g BIT4    //p1.4
+#define BLINKY_DELAY_MS 3000 //Change this as per your needs
 
-//Digit dots on LED
-#define DOT BIT5 //p2.5
+#define AXIS_EMA_SHIFT 2 //average of about 4 samples, 0.2s at 21 samples a second
 
-#define ADC_INPUT_X BIT0 //p1.0 for ADC
-#define ADC_INPUT_Y BIT1 //p1.1 for ADC
-#define ADC_INPUT_Z BIT2 //p1.2 for ADC
+#define CALIBRATE_HOLD_MS 2000 //holding the button this long calibrates the axes
 
-#define LED_DIGITS 4
+// RAM of the MSP430G2553 and what is kept of it for the stack: the deepest
+// call, display_g() down to quad_led_field_number(), with an interrupt on top.
+// Give the linker the same --stack_size so it fails when the RAM is full
+#define RAM_SIZE 512
+#define STACK_BUDGET 128
 
-#define DIGDELAY 4000 //Number of cycles to delay for displaying each digit in display_digits
-#define BLINKY_DELAY_MS 3000 //Change this as per your needs
+unsigned int OFCount;
+volatile unsigned int milliseconds = 0; // timestamps of the ADC samples
 
-// to track which digits of led are on
-unsigned char digits_on = 0x00;
+adc_sample_t adc[ADC_CHANNELS];
 
-unsigned int OFCount;
+// every axis is filtered with every sample, whichever one is on the display,
+// so switching axes shows a settled value at once
+ema_filter_t axis_average[ADC_CHANNELS];
+unsigned int axis_value[ADC_CHANNELS]; // output of axis_average, by channel
 
-unsigned int adc[3];
+// fraction bits of the milli-g per count of the calibration
+#define MG_FRACTION_BITS 8
 
-typedef enum
+// calibration of an axis, found by measuring the raw values of the axis at
+// both +1 and -1 g
+typedef struct
+{
+    unsigned int zero_g; // raw value at 0 g, until the board is calibrated
+    unsigned int counts_per_g; // raw change for 1 g
+    unsigned int mg_per_count; // milli-g per count times 2^MG_FRACTION_BITS
+} axis_calibration_t;
+
+// calibration from the 10 bit value at 0 g and the 10 bit counts per g
+#define AXIS_CALIBRATION(zero_g, counts_per_g) \
+    { (zero_g) * ADC_GAIN, (counts_per_g) * ADC_GAIN, \
+      (unsigned int) ((1000UL << MG_FRACTION_BITS) / ((counts_per_g) * ADC_GAIN)) }
+
+// by channel, x, y and z
+const axis_calibration_t axis_calibration[ADC_CHANNELS] =
 {
-    A_SEGMENT = 0,
-    B_SEGMENT,
-    C_SEGMENT,
-    D_SEGMENT,
-    E_SEGMENT,
-    F_SEGMENT,
-    G_SEGMENT,
-    DP,
-} LED_SEGMENTS;
+    AXIS_CALIBRATION(482, 90),
+    AXIS_CALIBRATION(467, 100),
+    AXIS_CALIBRATION(487, 90)
+};
+
+// raw value at 0 g of each axis, by channel, from the information flash
+unsigned int axis_zero_g[ADC_CHANNELS];
+// milliseconds when the button was last seen up
+unsigned int button_up_ms = 0;
 
 // enum for states
 typedef enum
@@ -56,25 +71,17 @@ typedef enum
 //to track current state of machine
 volatile STATES current_state;
 
-//enum for numbers/characters on LED
-typedef enum
-{
-    NUM_0,
-    NUM_1,
-    NUM_2,
-    NUM_3,
-    NUM_4,
-    NUM_5,
-    NUM_6,
-    NUM_7,
-    NUM_8,
-    NUM_9,
-    CHAR_X,
-    CHAR_Y,
-    CHAR_Z,
-    CHAR_DASH
-} LED_CHARS;
+// static RAM of main.c, the sampler and the display driver
+#define RAM_USED (ADC_SAMPLER_RAM + QUAD_LED_RAM \
+                  + sizeof(OFCount) + sizeof(milliseconds) \
+                  + sizeof(adc) + sizeof(axis_average) + sizeof(axis_value) \
+                  + sizeof(current_state) + sizeof(axis_zero_g) \
+                  + sizeof(button_up_ms))
 
+#ifdef __MSP430__
+// fails to compile when the static RAM leaves less than STACK_BUDGET
+typedef char ram_budget_check[(RAM_USED + STACK_BUDGET <= RAM_SIZE) ? 1 : -1];
+#endif
 
 //******************************************************************************
 //Module Function configureAdc(), Last Revision date 10/6/2022, by Owen
@@ -84,77 +91,56 @@ typedef enum
 void configureAdc();
 
 //******************************************************************************
-//Module Function read_adc(), Last Revision date 10/6/2022, by Owen
-//Reads ADC_INPUT of ADC and populates an array with the values as unsigned int
-//Relies on Global variable. Based on examples shared in Lab 3 Asignment PDF
-//*******************************************************************************
-unsigned int read_adc(char axis);
-
-//******************************************************************************
-//Module Function read_adc_median_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the median of them
-//Ultimately not used do to combination of time and oscillation
+//Module Function axis_channel()
+//Returns the ADC channel of an axis, 'x', 'y' or 'z'
 //*******************************************************************************
-unsigned int read_adc_median_filtered(volatile unsigned int number, char axis);
+unsigned int axis_channel(char axis);
 
 //******************************************************************************
-//Module Function read_adc_running_average_filter(), Last Revision date 9/22/2022, by Owen
-//Taking the old average, and the weight, which is set above, calculates the new running average
+//Module Function filter_axes()
+//Waits for the next sequence and runs it, and any other sequence queued, through
+//the filter of each axis. The filtered values are in axis_value
 //Idea from https://electronics.stackexchange.com/questions/157977/should-i-always-put-a-low-pass-filter-on-an-adc-input
-//The higher the weight, the more oscillations are damped down
 //*******************************************************************************
-unsigned int read_adc_running_average_filter(unsigned int oldaverage,
-                                             unsigned int weight,char axis);
+void filter_axes(void);
 
-//******************************************************************************
-//Module Function led_display_num(), Last Revision date 9/22/2022, by Gandhar
-//Taking in a value, lights all of the segments required so that the value can be displayed
-//Requires that the correct pins be declared on the top
-//*******************************************************************************
-void led_display_num(LED_CHARS led_char);
-
-//******************************************************************************
-//Module Function lit_let_segment(), Last Revision date 9/22/2022, by Gandhar
-//Given a segment, turn it on.
-//*******************************************************************************
-void lit_led_segment(LED_SEGMENTS segment);
 //******************************************************************************
 //Module Function display_digits(), Last Revision date 9/22/2022, by Gandhar
-//Given a number to display, turns on the digits in display that need to be turned on
-//Then displays the digit, delaying an amount of time set in macros to improve persistence of vision
+//Given a number to display, puts it on the display with the decimal point
+//of the digit that marks the axis: digit 1 for x, 2 for y and 3 for z
 //*******************************************************************************
 void display_digits(unsigned int val, char axis);
 //******************************************************************************
 //Module Function display_g(), Last Revision date 1/5/2022, by Owen
-//Given the values that are needed  to display, turns on the digits in display that need to be turned on
-//Then displays the digit, delaying an amount of time set in macros to improve persistence of vision
+//Given the raw value and its axis, puts the axis and the value in g with one
+//decimal and its sign on the display
 //*******************************************************************************
 void display_g(unsigned int grav, char axis);
 //******************************************************************************
-//Module Function turn_off_led_segments(), Last Revision date 9/28/2022, by Gandhar
-//Turns off All LED Segements as set in global variables, thus zeroing out display
-//*******************************************************************************
-void turn_off_led_segments();
-//******************************************************************************
-//Module Function turn_off_led_digits(), Last Revision date 9/28/2022, by Gandhar
-//Turns off All LED Digits that are marked in global variables, thus zeroing out display
-//*******************************************************************************
-void turn_off_led_digits();
-//******************************************************************************
 //Module Function turn_off_led_digits(), Last Revision date 10/6/2022, by Owen
-//Given the state (whether raw inputs or as g, the ADC Val, the old average, and the axis displayed
+//Given the state (whether raw inputs or as g) and the axis displayed
 //Displays a filtered version of the value in either raw or G value form
 //*******************************************************************************
-void display_state(bool isRawState, unsigned int *adc_val, unsigned int *oldavg,
-                   char axis);
+void display_state(bool isRawState, char axis);
 //******************************************************************************
 //Module Function maptoG(), Last Revision date 10/6/2022, by Owen
 //Given a the Raw ADC value, and the axis that the measurement was taken from,
-//Transforms it into the correct G value - found empirically by measuring raw values
-//from each axis on both +1 and -1 G (the only values that can be consistently gotten)
-//Using too many if statements, as well as too many magic numbers
+//Transforms it into milli-g with the calibration of the axis, negative below
+//0 g. One multiply and one shift whatever the tilt
+//*******************************************************************************
+int maptoG(unsigned int val, char axis);
+//******************************************************************************
+//Module Function load_calibration()
+//Takes the 0 g values calibrate_axes() keeps in the information flash, or the
+//ones in axis_calibration when the board has not been calibrated yet
 //*******************************************************************************
-unsigned int maptoG(unsigned int val, char axis);
+void load_calibration(void);
+//******************************************************************************
+//Module Function calibrate_axes()
+//Once the button is let go, averages the axes of the board lying flat and at
+//rest, z up, makes them the 0 g values and keeps them in the information flash
+//*******************************************************************************
+void calibrate_axes(void);
 //******************************************************************************
 //Module Function turn_off_led_digits(), Last Revision date 10/5/2022, by Owen
 //Helper Function, turns axis in Character, into an enum that the display function can
@@ -187,19 +173,11 @@ void main(void)
 {
     WDTCTL = WDTPW | WDTHOLD;       // stop watchdog timer
 
-    P2DIR |= DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4 + a + c + d + DOT;
-    P1DIR |= b + e + f + g;
-
-    P2SEL &= ~BIT6;  //enable p2.6 as gpio
-    P2SEL &= ~BIT7;  //enable p2.7 as gpio
-
-    volatile unsigned int i = 0;
-    unsigned int oldaverage = 0;
-    P2OUT &= ~(DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4); //all digits off by default
+    load_calibration();
+    quad_led_init(); //display pins as in led_pins.h, all digits off by default
     configureAdc();
-    unsigned int adc_val = read_adc('x');
-    oldaverage = adc_val;
-    display_digits(adc_val, 'x'); //The problem with Running Average is that it there can be a "ramp up", displaying one value in beginning helps mitigate this
+    filter_axes(); // the first sample primes the filters
+    display_digits(axis_value[ADC_CHANNEL_X], 'x'); //The problem with Running Average is that it there can be a "ramp up", displaying one value in beginning helps mitigate this
 
     //set to rawX as default state
     current_state = rawX;
@@ -209,40 +187,45 @@ void main(void)
 
     while (1)
     {
-
-        digits_on = 0x00;
-
-
+        // the button pulls p1.3 low while pressed
+        if (P1IN & BIT3)
+        {
+            button_up_ms = milliseconds;
+        }
+        else if (milliseconds - button_up_ms >= CALIBRATE_HOLD_MS)
+        {
+            calibrate_axes();
+        }
         switch (current_state)
         {
         case rawX:
         {
-            display_state(true, &adc_val, &oldaverage, 'x');
+            display_state(true, 'x');
             break;
         }
         case rawY:
         {
-            display_state(true, &adc_val, &oldaverage, 'y');
+            display_state(true, 'y');
             break;
         }
         case rawZ:
         {
-            display_state(true, &adc_val, &oldaverage, 'z');
+            display_state(true, 'z');
             break;
         }
         case g_x:
         {
-            display_state(false, &adc_val, &oldaverage, 'x');
+            display_state(false, 'x');
             break;
         }
         case g_y:
         {
-            display_state(false, &adc_val, &oldaverage, 'y');
+            display_state(false, 'y');
             break;
         }
         case g_z:
         {
-            display_state(false, &adc_val, &oldaverage, 'z');
+            display_state(false, 'z');
             break;
         }
         default:
@@ -253,25 +236,19 @@ void main(void)
 }
 //******************************************************************************
 //Module Function turn_off_led_digits(), Last Revision date 10/6/2022, by Owen
-//Given the state (whether raw inputs or as g, the ADC Val, the old average, and the axis displayed
+//Given the state (whether raw inputs or as g) and the axis displayed
 //Displays a filtered version of the value in either raw or G value form
 //*******************************************************************************
-void display_state(bool isRawState, unsigned int *adc_val, unsigned int *oldavg,
-                   char axis)
+void display_state(bool isRawState, char axis)
 {
+    filter_axes();
     if (isRawState)
     {
-        *adc_val = read_adc(axis);
-        *adc_val = read_adc_running_average_filter(*oldavg, 10,axis);
-        display_digits(*adc_val, axis);
-        *oldavg = *adc_val;
+        display_digits(axis_value[axis_channel(axis)], axis);
     }
     else
     {
-        *adc_val = read_adc(axis);
-        *adc_val = read_adc_running_average_filter(*oldavg, 10,axis);
-        display_g(*adc_val, axis);
-        *oldavg = *adc_val;
+        display_g(axis_value[axis_channel(axis)], axis);
     }
 }
 
@@ -282,499 +259,123 @@ void display_state(bool isRawState, unsigned int *adc_val, unsigned int *oldavg,
 //*******************************************************************************
 void configureAdc()
 {
-    ADC10CTL0 &= ~ENC;                        // Disable ADC
+    unsigned int ch;
 
-    ADC10CTL0 = SREF_0 + ADC10SHT_3 + MSC + ADC10ON; //ADC10IE
-    ADC10CTL1 = INCH_2 + CONSEQ_3; // Channel 3, Three Readings,
-    ADC10DTC1 = 3;
-    ADC10AE0 |= ADC_INPUT_X + ADC_INPUT_Y + ADC_INPUT_Z;
+    adc_sampler_init(); // channels 2 to 0 sampled by Timer0_A, pins in adc_pins.h
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        ema_filter_init(&axis_average[ch], AXIS_EMA_SHIFT);
+    }
 }
 
 //******************************************************************************
-//Module Function read_adc(), Last Revision date 10/6/2022, by Owen
-//Reads ADC_INPUT of ADC and populates an array with the values as unsigned int
-//Relies on Global variable
+//Module Function axis_channel()
+//Returns the ADC channel of an axis, 'x', 'y' or 'z'
 //*******************************************************************************
-unsigned int read_adc(char axis)
+unsigned int axis_channel(char axis)
 {
-    ADC10CTL0 &= ~ENC;
-    while (ADC10CTL1 & ADC10BUSY)
-        ;
-    ADC10CTL0 |= ENC + ADC10SC;
-    ADC10SA = (unsigned int) adc;
-
     switch (axis)
     {
-    case 'x':
-        return adc[2];
     case 'y':
-        return adc[1];
+        return ADC_CHANNEL_Y;
     case 'z':
-        return adc[0];
+        return ADC_CHANNEL_Z;
+    default:
+        return ADC_CHANNEL_X;
     }
 }
 
 //******************************************************************************
-//Module Function read_adc_running_average_filter(), Last Revision date 9/22/2022, by Owen
-//Taking the old average, and the weight, which is set above, calculates the new running average
-//The higher the weight, the more oscillations are damped down
+//Module Function filter_axes()
+//Waits for the next sequence and runs it, and any other sequence queued, through
+//the filter of each axis. The filtered values are in axis_value
+//Idea from https://electronics.stackexchange.com/questions/157977/should-i-always-put-a-low-pass-filter-on-an-adc-input
 //*******************************************************************************
-unsigned int read_adc_running_average_filter(unsigned int oldaverage,
-                                             unsigned int weight,char axis)
+void filter_axes(void)
 {
-    unsigned int average;
-    unsigned int value = read_adc(axis);
-    average = (oldaverage * weight + value) / (weight + 1); //Simple running average formula
-    return average;
-}
+    unsigned int queued, ch;
 
-//******************************************************************************
-//Module Function read_adc_median_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the median of them
-//Ultimately not used do to combination of time and oscillation
-//*******************************************************************************
-
-unsigned int read_adc_median_filtered(volatile unsigned int number, char axis)
-{
-    unsigned int arr[number];
-    volatile unsigned int i,j,tmp;
-
-    for(i = number; i > 0; i--) { //reads ADC certain number of times
-        arr[i] = read_adc(axis);
-    }
-
-    for(i=0;i<number;i++) //Algorithm taken from robotics class last semester
-    {                     //Sorts the array by size
-        for(j=0; j < number; j++)
+    do
+    {
+        queued = adc_sampler_next(adc); // sleeps until there is a sequence not read yet
+        for (ch = 0; ch < ADC_CHANNELS; ch++)
         {
-            if(arr[j] > arr[i]) {
-                tmp = arr[i];
-                arr[i] = arr[j];
-                arr[j] = tmp;
-            }
+            axis_value[ch] = ema_filter_update(&axis_average[ch], adc[ch].value);
         }
-    }
-    return arr[number / 2]; //returns the middle value in the array, which is the Median
-}
-//******************************************************************************
-//Module Function turn_off_led_segments(), Last Revision date 9/28/2022, by Gandhar
-//Turns off All LED Segements as set in global variables, thus zeroing out display
-//*******************************************************************************
-void turn_off_led_segments()
-{
-    // turn off all segments first
-    P1OUT |= b + e + f + g;
-    P2OUT |= a + c + d + DOT;
-}
-//******************************************************************************
-//Module Function turn_off_led_digits(), Last Revision date 9/28/2022, by Gandhar
-//Turns off All LED Digits that are marked in global variables, thus zeroing out display
-//*******************************************************************************
-void turn_off_led_digits()
-{
-    P2OUT &= ~(DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4);
+    } while (queued);
 }
+
 //******************************************************************************
-//Module Function led_display_num(), Last Revision date 9/22/2022, by Gandhar
-//Taking in a value, lights all of the segments required so that the value can be displayed
-//Requires that the correct pins be declared on the top
+//Module Function display_digits(), Last Revision date 9/22/2022, by Gandhar
+//Given a number to display, puts it on the display with the decimal point
+//of the digit that marks the axis: digit 1 for x, 2 for y and 3 for z
 //*******************************************************************************
-void led_display_num(LED_CHARS led_char)
+void display_digits(unsigned int val, char axis)
 {
-    turn_off_led_segments();
-    //For each number, light the needed segments using program lit_let_segment
-    switch (led_char)
-    {
-    case NUM_0:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        break;
-    }
-    case NUM_1:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-    case NUM_2:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case NUM_3:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case NUM_4:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case NUM_5:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case NUM_6:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case NUM_7:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-
-    case NUM_8:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-
-    }
-    case NUM_9:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case CHAR_X:
+    if (axis == 'x')
     {
-        //for displaying char X
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
+        quad_led_show_number_dp(val, 0);
     }
-    case CHAR_Y:
+    else if (axis == 'y')
     {
-        //for displaying char Y
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
+        quad_led_show_number_dp(val, 1);
     }
-    case CHAR_Z:
+    else if (axis == 'z')
     {
-        //for displaying char Z
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
+        quad_led_show_number_dp(val, 2);
     }
-    case CHAR_DASH:
+    else
     {
-        //for displaying sign '-'
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    default:
-        lit_led_segment(G_SEGMENT);
-        break;
+        quad_led_show_number(val);
     }
 }
-
 //******************************************************************************
-//Module Function lit_let_segment(), Last Revision date 9/22/2022, by Gandhar
-//Given a segment, turn it on.
+//Module Function maptoG(), Last Revision date 10/6/2022, by Owen
+//Given a the Raw ADC value, and the axis that the measurement was taken from,
+//Transforms it into milli-g with the calibration of the axis, negative below
+//0 g. One multiply and one shift whatever the tilt
 //*******************************************************************************
-void lit_led_segment(LED_SEGMENTS segment)
+int maptoG(unsigned int val, char axis)
 {
-    switch (segment)
-    {
-    case A_SEGMENT:
-    {
-        P2OUT &= ~a;
-        break;
-    }
-    case B_SEGMENT:
-    {
-        P1OUT &= ~b;
-        break;
-    }
-    case C_SEGMENT:
-    {
-        P2OUT &= ~c;
-        break;
-    }
-    case D_SEGMENT:
-    {
-        P2OUT &= ~d;
-        break;
-    }
-    case E_SEGMENT:
-    {
-        P1OUT &= ~e;
-        break;
-    }
-    case F_SEGMENT:
-    {
-        P1OUT &= ~f;
-        break;
-    }
-    case G_SEGMENT:
-    {
-        P1OUT &= ~g;
-        break;
-    }
-    case DP:
-    {
-        P2OUT &= ~DOT;
-    }
-    default:
-        break;
-    }
-}
-
-void display_decimal_point(char axis, unsigned char on_digits)
-{
-    if (axis == 'x')
-    {
-        if (!(on_digits & (1 << 3))) //check if digit-1 is turned off and then turn on to show dp
-        {
-            P2OUT = DIGIT_1;
-            turn_off_led_segments();
-        }
-
-        lit_led_segment(DP);
-    }
-    else if (axis == 'y')
-    {
-        if (!(on_digits & (1 << 2))) //check if digit-2 is turned off and then turn on to show dp
-        {
-            P2OUT = DIGIT_2;
-            turn_off_led_segments();
-        }
+    unsigned int ch = axis_channel(axis);
+    const axis_calibration_t *cal = &axis_calibration[ch];
+    long counts = (long) val - axis_zero_g[ch];
 
-        lit_led_segment(DP);
-    }
-    else if (axis == 'z')
-    {
-        if (!(on_digits & (1 << 1))) //check if digit-3 is turned off and then turn on to show dp
-        {
-            P2OUT = DIGIT_3;
-            turn_off_led_segments();
-        }
-
-        lit_led_segment(DP);
-    }
-    _delay_cycles(DIGDELAY);
+    // rounded to the nearest milli-g, the shift rounds down for both signs
+    return (int) ((counts * cal->mg_per_count
+                   + (1L << (MG_FRACTION_BITS - 1))) >> MG_FRACTION_BITS);
 }
-
 //******************************************************************************
-//Module Function display_digits(), Last Revision date 9/22/2022, by Gandhar
-//Given a number to display, turns on the digits in display that need to be turned on
-//Then displays the digit, delaying an amount of time set in macros to improve persistence of vision
+//Module Function load_calibration()
+//Takes the 0 g values calibrate_axes() keeps in the information flash, or the
+//ones in axis_calibration when the board has not been calibrated yet
 //*******************************************************************************
-void display_digits(unsigned int val, char axis)
+void load_calibration(void)
 {
-    turn_off_led_digits();
-
-    unsigned int digit = 0;
-    unsigned int number = val;
-    volatile unsigned int i;
-
-    if (val >= 0 && val <= 9)
-    {
-        //If the number is less than 10, turn on first digit and display the value
-        digits_on = 1 << 0;
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        display_decimal_point(axis, digits_on);
-    }
-    else if (val >= 10 && val <= 99)
-    {
-        //If the number is more than 10, but less than 99
-        //Turn on 1s place digit, display value, and delay
-        //Then extract 10s place digit and repeat
-        digits_on = (1 << 0) + (1 << 1);
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        if (axis == 'z')
-        {
-            display_decimal_point('z', digits_on);
-        }
-        else if (axis == 'y')
-        {
-            display_decimal_point('y', digits_on);
-        }
-        else if (axis == 'x')
-        {
-            display_decimal_point('x', digits_on);
-        }
+    unsigned int ch;
 
-    }
-    else if (val >= 100 && val <= 999)
-    {
-        //If the number is more than 10, but less than 99
-        //Turn on 1s place digit, display value, and delay
-        //Then extract 10s place digit and repeat
-        //Then extract 1000s place digit and repeat again
-
-        digits_on = (1 << 0) + (1 << 1) + (1 << 2);
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        digits_on |= 1 << 0;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-
-        if (axis == 'z')
-        {
-            display_decimal_point('z', digits_on);
-        }
-        _delay_cycles(DIGDELAY);
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        if (axis == 'y')
-        {
-            display_decimal_point('y', digits_on);
-        }
-        else if (axis == 'x')
-        {
-            display_decimal_point('x', digits_on);
-        }
-
-    }
-    else if (val >= 1000 && val <= 9999)
+    if (!info_flash_load(axis_zero_g, ADC_CHANNELS))
     {
-        //Do the same process as above, but for all 4 digits.
-        digits_on = (1 << 0) + (1 << 1) + (1 << 2) + (1 << 3);
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-
-        if (axis == 'z')
+        for (ch = 0; ch < ADC_CHANNELS; ch++)
         {
-            display_decimal_point('z', digits_on);
-        }
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-
-        if (axis == 'y')
-        {
-            display_decimal_point('y', digits_on);
-        }
-        digit = (number / 1000) % 10;
-        P2OUT = DIGIT_1;
-        led_display_num(digit);
-        _delay_cycles(DIGDELAY);
-
-        if (axis == 'x')
-        {
-            display_decimal_point('x', digits_on);
+            axis_zero_g[ch] = axis_calibration[ch].zero_g;
         }
     }
 }
 //******************************************************************************
-//Module Function maptoG(), Last Revision date 10/6/2022, by Owen
-//Given a the Raw ADC value, and the axis that the measurement was taken from,
-//Transforms it into the correct G value - found empirically by measuring raw values
-//from each axis on both +1 and -1 G (the only values that can be consistently gotten)
-//Using too many if statements, as well as too many magic numbers
+//Module Function calibrate_axes()
+//Once the button is let go, averages the axes of the board lying flat and at
+//rest, z up, makes them the 0 g values and keeps them in the information flash
 //*******************************************************************************
-unsigned int maptoG(unsigned int val, char axis)
+void calibrate_axes(void)
 {
-    unsigned int gmap;
-    volatile unsigned int gval = 0;
-
-    if(axis == 'x' && val >= 482) {
-        gmap = val - 482;
-    }
-    else if(axis == 'x' && val < 482) {
-            gmap = 482 - val;
-        }
-    else if(axis == 'y' && val >= 467) {
-            gmap = val - 467;
-        }
-    else if(axis == 'y' && val < 467) {
-            gmap = 467 - val;
-        }
-    else if(axis == 'z' && val >= 487) {
-            gmap = val - 487;
-        }
-    else if(axis == 'z' && val < 487) {
-            gmap = 487 - val;
-        }
-    if(axis == 'y') {
-        for(gval = 0; gval < 102; gval++) {
-            if(gval * 10 > gmap){
-                break;
-            }
-        }
-    }
-    else {
-        for(gval = 0; gval < 102; gval++) {
-                    if(gval * 9 > gmap){
-                        break;
-                    }
-                }
-    }
-
-    return gval;
+    while (!(P1IN & BIT3))
+        ;
+    adc_sampler_average(axis_zero_g);
+    // z reads +1 g with the board flat
+    axis_zero_g[ADC_CHANNEL_Z] -= axis_calibration[ADC_CHANNEL_Z].counts_per_g;
+    info_flash_store(axis_zero_g, ADC_CHANNELS);
+    button_up_ms = milliseconds;
 }
 //******************************************************************************
 //Module Function turn_off_led_digits(), Last Revision date 10/5/2022, by Owen
@@ -801,37 +402,21 @@ LED_CHARS mapaxis(char axis) {
 
 //******************************************************************************
 //Module Function display_g(), Last Revision date 1/5/2022, by Owen
-//Given the values that are needed  to display, turns on the digits in display that need to be turned on
-//Then displays the digit, delaying an amount of time set in macros to improve persistence of vision
+//Given the raw value and its axis, puts the axis and the value in g with one
+//decimal and its sign on the display
 //*******************************************************************************
 void display_g(unsigned int grav, char axis)
 {
-    unsigned int digit = maptoG(grav, axis);
-    LED_CHARS charAxis = mapaxis(axis);
-    turn_off_led_digits();
-    //Do the same process as above, but for all 4 digits.
-    digits_on = (1 << 0) + (1 << 1) + (1 << 2) + (1 << 3);
-    P2OUT = DIGIT_1;
-    led_display_num(charAxis);
-    _delay_cycles(DIGDELAY);
-    P2OUT = DIGIT_2;
-      if(digit <= 30) {
-      led_display_num(CHAR_DASH);
-      _delay_cycles(DIGDELAY);
-      }
-      else {
-          turn_off_led_segments();
-      }
-
-    unsigned int tens = (digit / 10) % 10;
-    P2OUT = DIGIT_3;
-    led_display_num(tens);
-    _delay_cycles(DIGDELAY);
-    digit = (digit) % 10;
-    display_decimal_point('y', digits_on);
-    P2OUT = DIGIT_4;
-    led_display_num(digit);
-    _delay_cycles(DIGDELAY);
+    static const led_field_t g_layout[] = {
+        { FIELD_CHAR, 0, 1, 0 }, // axis
+        { FIELD_NUMBER, 1, 3, 1 } // g with one decimal, -9.9 to 9.9
+    };
+    int mg = maptoG(grav, axis);
+    int values[2];
+
+    values[0] = mapaxis(axis);
+    values[1] = (mg + (mg < 0 ? -50 : 50)) / 100; // tenths of a g, rounded
+    quad_led_show_fields(g_layout, values, 2);
 }
 //******************************************************************************
 //Module Function initTimer
@@ -841,13 +426,11 @@ void initTimer(void) {
     //Timer Configuration
     BCSCTL1 = CALBC1_1MHZ;
     DCOCTL = CALDCO_1MHZ;
-    TACCR0 = 0; //Initially, Stop the Timer
-    TACCTL0 |= CCIE; //Enable interrupt for CCR0.
-    TACTL = TASSEL_2 + ID_0 + MC_1; //Select SMCLK, SMCLK/1 , Up Mode
     OFCount  = 0;
-    TACCR0 = 1000-1; //Start Timer, Compare value for Up Mode to get 1ms delay per loop
-    /*Total count = TACCR0 + 1. Hence we need to subtract 1.
-    1000 ticks @ 1MHz will yield a delay of 1ms.*/
+    TACCTL0 |= CCIE; //Enable interrupt for CCR0.
+    /*Timer0_A is started by adc_sampler_init() in up mode with one period per
+    ADC conversion: 1000000 / (ADC_SAMPLE_RATE * 3) = 1001 ticks @ 1MHz,
+    so the interrupt still comes about every 1ms.*/
 }
 
 //******************************************************************************
@@ -868,6 +451,7 @@ void initButton(void) {
 //*******************************************************************************
 #pragma vector = TIMER0_A0_VECTOR
 __interrupt void timer_interupt(void) {
+    milliseconds++;
     OFCount++;
     if(OFCount >= BLINKY_DELAY_MS)  {
         if(current_state == rawX) {current_state = rawY;}
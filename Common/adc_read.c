@@ -0,0 +1,33 @@
+/*
+ *  adc_read.c
+ *  Single ADC10 conversions for the projects that read a channel now and then
+ *  Kept apart from adc_sampler.c, so these projects link neither the DTC
+ *  blocks and the queue nor the ADC10 interrupt of the timer paced sampler
+ */
+
+#include <msp430.h>
+#include "adc_sampler.h"
+
+//******************************************************************************
+//Module Function adc_sampler_read()
+//Converts one channel and returns once the result is in sample, polling
+//ADC10IFG. Takes about 60 us, for projects that do not run adc_sampler_init()
+//*******************************************************************************
+void adc_sampler_read(unsigned int channel, adc_sample_t *sample)
+{
+    ADC10CTL0 &= ~ENC;
+    while (ADC10CTL1 & ADC10BUSY)
+        ;
+    // Vcc & Vss as reference, sample and hold for 64 clock cycles, ADC on
+    ADC10CTL0 = SREF_0 + ADC10SHT_3 + ADC10ON;
+    ADC10CTL1 = channel * INCH_1 + ADC10DIV_3; // ADC10OSC/4, one conversion
+    ADC10DTC1 = 0; // result stays in ADC10MEM
+    ADC10AE0 |= ADC_INPUTS;
+    ADC10CTL0 |= ENC + ADC10SC;
+    // ADC10MEM still holds the last result until the new one is in
+    while (!(ADC10CTL0 & ADC10IFG))
+        ;
+    sample->time = ADC_TIME;
+    sample->value = ADC10MEM;
+    ADC10CTL0 &= ~ADC10IFG;
+}
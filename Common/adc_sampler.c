@@ -0,0 +1,227 @@
+/*
+ *  adc_sampler.c
+ *  Timer paced multi-channel ADC10 sampling shared by the projects
+ *  The DTC runs in two block continuous mode: while it fills one block the
+ *  other one holds the last ADC_OVERSAMPLES whole sequences, which the ADC10
+ *  interrupt sums into a queue of ADC_QUEUED_SEQUENCES samples per channel
+ */
+
+#include <msp430.h>
+#include "adc_sampler.h"
+
+// SMCLK of all the projects, the DCO calibrated to 1 MHz
+#define ADC_SMCLK_HZ 1000000UL
+
+// Timer_A starting the conversions. Only Timer0_A outputs can be the sample and
+// hold source of the ADC10: output 1 starts one conversion of the repeated
+// sequence on each rising edge, so it runs ADC_SEQUENCE_CHANNELS times faster
+// than the sequences. Timer1_A has no such output, its CCR0 interrupt starts a
+// whole sequence with ADC10SC instead, a few cycles late but still on time
+#if ADC_TRIGGER_TIMER == 1
+#define TRIGGER_CYCLES (ADC_SMCLK_HZ / ADC_SAMPLE_RATE)
+#else
+#define TRIGGER_CYCLES (ADC_SMCLK_HZ / ((unsigned long) ADC_SAMPLE_RATE \
+        * ADC_SEQUENCE_CHANNELS))
+#endif
+
+#define QUEUE_MASK (ADC_QUEUED_SEQUENCES - 1)
+
+// conversions in a DTC block
+#define BLOCK_CONVERSIONS (ADC_OVERSAMPLES * ADC_SEQUENCE_CHANNELS)
+
+// one sample of each channel in the queue
+typedef struct
+{
+    unsigned int value[ADC_CHANNELS]; // indexed by ADC_INDEX()
+    unsigned int time; // ADC_TIME when the last sequence was done
+} adc_sequence_t;
+
+// both DTC blocks of ADC_OVERSAMPLES sequences, the ADC10 converts the highest
+// channel of a sequence first
+static volatile unsigned int adc_blocks[2][BLOCK_CONVERSIONS];
+// samples of all channels, the newest ones at queue_head - 1
+static volatile adc_sequence_t queue[ADC_QUEUED_SEQUENCES];
+static volatile unsigned char queue_head = 0;
+// entries in the queue not taken by adc_sampler_next() yet
+static volatile unsigned char queue_used = 0;
+
+#ifdef __MSP430__
+// fails to compile when ADC_SAMPLER_RAM no longer adds up to the statics above
+typedef char adc_sampler_ram_check[(sizeof(adc_blocks) + sizeof(queue)
+        + sizeof(queue_head) + sizeof(queue_used) == ADC_SAMPLER_RAM) ? 1 : -1];
+#endif
+
+//******************************************************************************
+//Module Function adc_sampler_init()
+//Sets the inputs in adc_pins.h as analog inputs and starts the Timer_A that
+//converts channels ADC_HIGHEST_CHANNEL down to A0 ADC_SAMPLE_RATE times a
+//second, giving ADC_SAMPLE_RATE / ADC_OVERSAMPLES samples of each channel a
+//second. Interrupts need to be enabled
+//*******************************************************************************
+void adc_sampler_init(void)
+{
+    ADC10CTL0 &= ~ENC; // registers can only be changed with ENC off
+    while (ADC10CTL1 & ADC10BUSY)
+        ;
+    queue_head = 0;
+    queue_used = 0;
+    ADC10AE0 |= ADC_INPUTS;
+    // two blocks of ADC_OVERSAMPLES sequences, filled one after the other
+    ADC10DTC0 = ADC10TB + ADC10CT;
+    ADC10DTC1 = BLOCK_CONVERSIONS;
+    ADC10SA = (unsigned int) adc_blocks; // has to be set before starting
+#if ADC_TRIGGER_TIMER == 1
+    // Vcc & Vss as reference, sample and hold for 64 clock cycles, the whole
+    // sequence on one trigger, ADC on, interrupt when a block is full
+    ADC10CTL0 = SREF_0 + ADC10SHT_3 + MSC + ADC10ON + ADC10IE;
+    // one sequence from ADC_HIGHEST_CHANNEL down to A0 per ADC10SC, ADC10OSC
+    // so a conversion takes about 15 us
+    ADC10CTL1 = ADC_HIGHEST_CHANNEL * INCH_1 + ADC10SSEL_0 + CONSEQ_1;
+    ADC10CTL0 |= ENC;
+    if (!(TA1CTL & MC_3))
+    {
+        TA1CTL = TASSEL_2 + MC_2; // SMCLK, continuous mode
+    }
+    TA1CCR0 = TA1R + TRIGGER_CYCLES;
+    TA1CCTL0 = CCIE;
+#else
+    // Vcc & Vss as reference, sample and hold for 64 clock cycles, ADC on,
+    // interrupt when a block is full
+    ADC10CTL0 = SREF_0 + ADC10SHT_3 + ADC10ON + ADC10IE;
+    // repeated sequence from ADC_HIGHEST_CHANNEL down to A0, one conversion on
+    // each rising edge of Timer0_A output 1, ADC10OSC
+    ADC10CTL1 = ADC_HIGHEST_CHANNEL * INCH_1 + SHS_1 + ADC10SSEL_0 + CONSEQ_3;
+    ADC10CTL0 |= ENC;
+    // SMCLK, up mode, output 1 reset halfway and set again when the timer
+    // starts over, one rising edge per period
+    TA0CCR0 = TRIGGER_CYCLES - 1;
+    TA0CCR1 = TRIGGER_CYCLES / 2;
+    TA0CCTL1 = OUTMOD_7;
+    TA0CTL = TASSEL_2 + MC_1 + TACLR;
+#endif
+}
+
+//******************************************************************************
+//Module Function adc_sampler_next()
+//Takes the oldest queued samples, sleeping in LPM0 until there are some,
+//copies them to samples, indexed by ADC_INDEX(), and returns how many are
+//still queued. Called for all of them, they are ADC_OVERSAMPLES sequences apart
+//*******************************************************************************
+unsigned int adc_sampler_next(adc_sample_t samples[ADC_CHANNELS])
+{
+    const volatile adc_sequence_t *sequence;
+    unsigned int channel;
+    unsigned int left;
+    // interrupts off between the check and going to sleep, or the interrupt
+    // could come in between and the CPU would sleep until the next sample,
+    // and while copying so the sample is not overwritten
+    __disable_interrupt();
+    while (queue_used == 0)
+    {
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    sequence = &queue[(queue_head - queue_used) & QUEUE_MASK];
+    for (channel = 0; channel < ADC_CHANNELS; channel++)
+    {
+        samples[channel].value = sequence->value[channel];
+        samples[channel].time = sequence->time;
+    }
+    left = --queue_used;
+    __enable_interrupt();
+    return left;
+}
+
+//******************************************************************************
+//Module Function adc_sampler_average()
+//Drops the queued samples and puts the average of the next
+//2^ADC_AVERAGE_SHIFT samples of each channel in averages, indexed by
+//ADC_INDEX(), sleeping in LPM0 until they are taken. For calibrating at rest
+//*******************************************************************************
+void adc_sampler_average(unsigned int averages[ADC_CHANNELS])
+{
+    const volatile adc_sequence_t *sequence;
+    unsigned int channel;
+    unsigned int taken;
+
+    for (channel = 0; channel < ADC_CHANNELS; channel++)
+    {
+        averages[channel] = 0; // the sums, at most 2^16 - 1
+    }
+    // samples from before the call may be from before the board was at rest
+    __disable_interrupt();
+    queue_used = 0;
+    for (taken = 0; taken < (1U << ADC_AVERAGE_SHIFT); taken++)
+    {
+        // interrupts off between the check and going to sleep, as in
+        // adc_sampler_next()
+        while (queue_used == 0)
+        {
+            __bis_SR_register(LPM0_bits + GIE);
+            __disable_interrupt();
+        }
+        sequence = &queue[(queue_head - queue_used) & QUEUE_MASK];
+        for (channel = 0; channel < ADC_CHANNELS; channel++)
+        {
+            averages[channel] += sequence->value[channel];
+        }
+        queue_used--;
+    }
+    __enable_interrupt();
+    for (channel = 0; channel < ADC_CHANNELS; channel++)
+    {
+        // rounded, shifted in two steps so the sum does not overflow
+        averages[channel] = ((averages[channel] >> (ADC_AVERAGE_SHIFT - 1)) + 1)
+                >> 1;
+    }
+}
+
+//******************************************************************************
+//interrupt adc_interrupt()
+//Called by the ADC10 each time the DTC has filled a block, queues the sum of
+//the conversions of each channel from ADC_LOWEST_CHANNEL up in it, dropping
+//the oldest samples if the queue is full, and wakes up the main loop
+//*******************************************************************************
+#pragma vector = ADC10_VECTOR
+__interrupt void adc_interrupt(void)
+{
+    // ADC10B1 is set when the first block is the one that was filled
+    const volatile unsigned int *block = adc_blocks[(ADC10DTC0 & ADC10B1) ? 0 : 1];
+    volatile adc_sequence_t *sequence = &queue[queue_head];
+    unsigned int channel;
+    unsigned int i;
+
+    for (channel = ADC_LOWEST_CHANNEL; channel <= ADC_HIGHEST_CHANNEL; channel++)
+    {
+        const volatile unsigned int *conversion =
+                &block[ADC_HIGHEST_CHANNEL - channel];
+        unsigned int sum = 0; // at most 64 * 1023, fits
+        for (i = 0; i < ADC_OVERSAMPLES; i++)
+        {
+            sum += *conversion;
+            conversion += ADC_SEQUENCE_CHANNELS;
+        }
+        sequence->value[ADC_INDEX(channel)] = sum >> ADC_OVERSAMPLE_BITS;
+    }
+    sequence->time = ADC_TIME;
+    queue_head = (queue_head + 1) & QUEUE_MASK;
+    if (queue_used < ADC_QUEUED_SEQUENCES)
+    {
+        queue_used++;
+    }
+    __bic_SR_register_on_exit(LPM0_bits);
+}
+
+#if ADC_TRIGGER_TIMER == 1
+//******************************************************************************
+//interrupt adc_trigger_interrupt()
+//Called by Timer1_A CCR0 once per sequence, schedules the next one and starts
+//this one
+//*******************************************************************************
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void adc_trigger_interrupt(void)
+{
+    TA1CCR0 += TRIGGER_CYCLES;
+    ADC10CTL0 |= ADC10SC;
+}
+#endif
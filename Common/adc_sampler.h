@@ -0,0 +1,122 @@
+/*
+ *  adc_sampler.h
+ *  Timer paced multi-channel ADC10 sampling shared by the projects
+ *  A Timer_A starts a sequence of channels ADC_SAMPLE_RATE times a second, the
+ *  DTC moves the results of 4^ADC_OVERSAMPLE_BITS sequences into one of two
+ *  blocks and the ADC10 interrupt sums each block into one queued sample per
+ *  channel, so the samples are evenly spaced whatever the main loop is busy
+ *  with. Projects that only need a channel now and then read it
+ *  with a single conversion instead, from adc_read.c. Each project lists its channels, the
+ *  trigger and the clock its samples are timestamped with in adc_pins.h
+ */
+
+#ifndef ADC_SAMPLER_H_
+#define ADC_SAMPLER_H_
+
+#include "adc_pins.h"
+
+// channels A0 up to ADC_HIGHEST_CHANNEL are converted in every sequence
+#define ADC_SEQUENCE_CHANNELS (ADC_HIGHEST_CHANNEL + 1)
+
+// lowest channel queued, the ones below it are converted, as the ADC10 always
+// runs a sequence down to A0, but take no room in the queue. Projects reading
+// only the upper channels set it in adc_pins.h
+#ifndef ADC_LOWEST_CHANNEL
+#define ADC_LOWEST_CHANNEL 0
+#endif
+
+#if ADC_LOWEST_CHANNEL > ADC_HIGHEST_CHANNEL
+#error "ADC_LOWEST_CHANNEL has to be at most ADC_HIGHEST_CHANNEL"
+#endif
+
+// channels queued, ADC_LOWEST_CHANNEL up to ADC_HIGHEST_CHANNEL
+#define ADC_CHANNELS (ADC_HIGHEST_CHANNEL - ADC_LOWEST_CHANNEL + 1)
+// index of a channel in the samples of adc_sampler_next() and
+// adc_sampler_average()
+#define ADC_INDEX(channel) ((channel) - ADC_LOWEST_CHANNEL)
+
+// projects that only call adc_sampler_read() leave the trigger out of adc_pins.h
+#ifndef ADC_TRIGGER_TIMER
+#define ADC_TRIGGER_TIMER 0
+#endif
+#ifndef ADC_SAMPLE_RATE
+#define ADC_SAMPLE_RATE 100
+#endif
+#ifndef ADC_OVERSAMPLE_BITS
+#define ADC_OVERSAMPLE_BITS 0
+#endif
+// and projects that do not need timestamps leave out the clock, so no timer
+// has to run for it
+#ifndef ADC_TIME
+#define ADC_TIME 0
+#endif
+
+#if ADC_SAMPLE_RATE < 100 || ADC_SAMPLE_RATE > 2000
+#error "ADC_SAMPLE_RATE has to be 100 to 2000 sequences a second"
+#endif
+
+// sequences summed into one sample, 4^ADC_OVERSAMPLE_BITS
+#define ADC_OVERSAMPLES (1 << (2 * ADC_OVERSAMPLE_BITS))
+// bits of the samples of adc_sampler_next() and adc_sampler_average(), and
+// their gain over a single 10 bit conversion: the sum of the conversions is
+// shifted right by ADC_OVERSAMPLE_BITS only, keeping the extra bits the noise
+// averaged out. adc_sampler_read() results stay 10 bit
+#define ADC_RESULT_BITS (10 + ADC_OVERSAMPLE_BITS)
+#define ADC_GAIN (1 << ADC_OVERSAMPLE_BITS)
+
+#if ADC_OVERSAMPLE_BITS > 3 || ADC_OVERSAMPLES * ADC_SEQUENCE_CHANNELS > 255
+#error "a DTC block holds at most 255 conversions and the sums 16 bits"
+#endif
+
+// samples of each channel queued for adc_sampler_next(), a power of two
+#define ADC_QUEUED_SEQUENCES 8
+
+// bytes of static RAM the sampler takes on the MSP430: both DTC blocks, the
+// queue and its two counters. For RAM budget checks at build time
+#define ADC_SAMPLER_RAM (4 * ADC_OVERSAMPLES * ADC_SEQUENCE_CHANNELS \
+                         + 2 * (ADC_CHANNELS + 1) * ADC_QUEUED_SEQUENCES + 2)
+
+// adc_sampler_average() averages 2^ADC_AVERAGE_SHIFT samples, as many as a 16
+// bit sum holds
+#define ADC_AVERAGE_SHIFT (16 - ADC_RESULT_BITS)
+
+// one conversion result and when it was ready
+typedef struct
+{
+    unsigned int value; // ADC_RESULT_BITS result
+    unsigned int time; // ADC_TIME when the result was ready, units in adc_pins.h
+} adc_sample_t;
+
+//******************************************************************************
+//Module Function adc_sampler_init()
+//Sets the inputs in adc_pins.h as analog inputs and starts the Timer_A that
+//converts channels ADC_HIGHEST_CHANNEL down to A0 ADC_SAMPLE_RATE times a
+//second, giving ADC_SAMPLE_RATE / ADC_OVERSAMPLES samples of each channel a
+//second. Interrupts need to be enabled
+//*******************************************************************************
+void adc_sampler_init(void);
+
+//******************************************************************************
+//Module Function adc_sampler_next()
+//Takes the oldest queued samples, sleeping in LPM0 until there are some,
+//copies them to samples, indexed by ADC_INDEX(), and returns how many are
+//still queued. Called for all of them, they are ADC_OVERSAMPLES sequences apart
+//*******************************************************************************
+unsigned int adc_sampler_next(adc_sample_t samples[ADC_CHANNELS]);
+
+//******************************************************************************
+//Module Function adc_sampler_average()
+//Drops the queued samples and puts the average of the next
+//2^ADC_AVERAGE_SHIFT samples of each channel in averages, indexed by
+//ADC_INDEX(), sleeping in LPM0 until they are taken. For calibrating at rest
+//*******************************************************************************
+void adc_sampler_average(unsigned int averages[ADC_CHANNELS]);
+
+//******************************************************************************
+//Module Function adc_sampler_read()
+//Converts one channel and returns once the result is in sample, polling
+//ADC10IFG. Takes about 60 us, for projects that do not run adc_sampler_init()
+//*******************************************************************************
+void adc_sampler_read(unsigned int channel, adc_sample_t *sample);
+
+#endif /* ADC_SAMPLER_H_ */
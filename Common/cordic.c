@@ -0,0 +1,104 @@
+/*
+ *  cordic.c
+ *  Integer angles and magnitudes of vectors, for tilt from the accelerometer
+ *  The vector is turned onto the x axis by rotations of atan(2^-i), each one a
+ *  shift and an add, and the rotations add up to its angle. The length grows
+ *  by the same factor every time, which is taken out again with shifts
+ */
+
+#include "cordic.h"
+
+// fraction bits of the angles while rotating, 1/16 of a tenth of a degree
+#define ANGLE_FRACTION_BITS 4
+// fraction bits of x and y while rotating
+#define VECTOR_FRACTION_BITS 8
+
+// atan(2^-i) in 1/16 of a tenth of a degree
+static const unsigned int rotation_angles[CORDIC_ITERATIONS] = {
+    7200, 4250, 2246, 1140, 572, 286, 143, 72, 36, 18, 9, 4, 2, 1
+};
+
+//******************************************************************************
+//Module Function cordic_atan2()
+//Returns the angle of the vector (x, y) from the x axis, -1800 to 1800 tenths
+//of a degree, and puts its length in magnitude unless magnitude is 0. Takes
+//x and y of up to 16 bits, 0 for (0, 0)
+//*******************************************************************************
+int cordic_atan2(int y, int x, unsigned int *magnitude)
+{
+    // scaled with a multiply, a left shift of a negative value is undefined,
+    // the compiler still makes it a shift
+    long vx = (long) x * (1L << VECTOR_FRACTION_BITS);
+    long vy = (long) y * (1L << VECTOR_FRACTION_BITS);
+    long turned;
+    long angle = 0;
+    unsigned char i;
+
+    // half turn first if it points left, the rotations only cover +-99 degrees
+    if (vx < 0)
+    {
+        angle = (vy < 0) ? -(1800L << ANGLE_FRACTION_BITS)
+                         : 1800L << ANGLE_FRACTION_BITS;
+        vx = -vx;
+        vy = -vy;
+    }
+    for (i = 0; i < CORDIC_ITERATIONS; i++)
+    {
+        turned = vx;
+        if (vy > 0)
+        {
+            vx += vy >> i;
+            vy -= turned >> i;
+            angle += rotation_angles[i];
+        }
+        else
+        {
+            vx -= vy >> i;
+            vy += turned >> i;
+            angle -= rotation_angles[i];
+        }
+    }
+    if (magnitude)
+    {
+        // the rotations made it 1.6468 times longer, 1/1.6468 is about
+        // 1/2 + 1/8 - 1/64 - 1/512
+        vx = (vx >> 1) + (vx >> 3) - (vx >> 6) - (vx >> 9);
+        *magnitude = (unsigned int) ((vx + (1L << (VECTOR_FRACTION_BITS - 1)))
+                                     >> VECTOR_FRACTION_BITS);
+    }
+    if (!x && !y)
+    {
+        return 0;
+    }
+    return (int) ((angle + (1L << (ANGLE_FRACTION_BITS - 1)))
+                  >> ANGLE_FRACTION_BITS);
+}
+
+//******************************************************************************
+//Module Function cordic_sqrt()
+//Returns the square root of value rounded down, one bit per step
+//*******************************************************************************
+unsigned int cordic_sqrt(unsigned long value)
+{
+    unsigned long root = 0;
+    unsigned long bit = 1UL << 30; // highest power of 4 in 32 bits
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned int) root;
+}
@@ -0,0 +1,28 @@
+/*
+ *  cordic.h
+ *  Integer angles and magnitudes of vectors, for tilt from the accelerometer
+ *  Angles are in tenths of a degree. Everything is shifts, adds and compares
+ *  in a fixed number of steps, with no floating point and no multiply
+ */
+
+#ifndef CORDIC_H_
+#define CORDIC_H_
+
+// rotations of the CORDIC, the last one turns by atan(2^-13) = 0.007 degrees
+#define CORDIC_ITERATIONS 14
+
+//******************************************************************************
+//Module Function cordic_atan2()
+//Returns the angle of the vector (x, y) from the x axis, -1800 to 1800 tenths
+//of a degree, and puts its length in magnitude unless magnitude is 0. Takes
+//x and y of up to 16 bits, 0 for (0, 0)
+//*******************************************************************************
+int cordic_atan2(int y, int x, unsigned int *magnitude);
+
+//******************************************************************************
+//Module Function cordic_sqrt()
+//Returns the square root of value rounded down, one bit per step
+//*******************************************************************************
+unsigned int cordic_sqrt(unsigned long value);
+
+#endif /* CORDIC_H_ */
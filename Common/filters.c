@@ -0,0 +1,516 @@
+/*
+ *  filters.c
+ *  Streaming filters for ADC samples shared by the projects
+ *  The median filter moves the one sample that changes through the sorted
+ *  window instead of sorting it again, so an update costs a binary search and
+ *  as many moves as the new sample is ranks away from the one it replaces
+ *  The median of 3 or 5 is a fixed network of min and max steps, with no loop
+ *  and no sorted window to keep
+ *  The EMA keeps the average scaled up by 2^shift, so the fraction a division
+ *  would truncate stays in the sum and the average settles on the input
+ *  exactly, with shifts and adds only
+ *  The CIC decimator sums the samples in order integrators and takes the
+ *  differences in order combs once per output, which is a boxcar average
+ *  order times over without a multiply or a buffer of samples
+ *  The tracker's gains are powers of two, so its corrections are shifts of
+ *  the innovation, and the innovation gate is one compare
+ *  The statistics add up each sample and its square once, less the first
+ *  sample of the window, and only divide when the mean or variance is asked for
+ */
+
+#include "filters.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+
+//******************************************************************************
+//Module Function median_filter_init()
+//Sets up an empty median filter of size samples, 1 to MEDIAN_WINDOW_MAX, over
+//the caller's ring and sorted arrays of size entries each
+//*******************************************************************************
+void median_filter_init(median_filter_t *filter, unsigned int *ring,
+                        unsigned int *sorted, unsigned int size)
+{
+    if (size > MEDIAN_WINDOW_MAX)
+    {
+        size = MEDIAN_WINDOW_MAX;
+    }
+    filter->ring = ring;
+    filter->sorted = sorted;
+    filter->size = (unsigned char) (size ? size : 1);
+    filter->count = 0;
+    filter->oldest = 0;
+}
+
+//******************************************************************************
+//Module Function median_filter_update()
+//Puts sample in the window in place of the oldest one and returns the median
+//of the window, the upper one of the two middle samples for even windows
+//Until the window is full the median is of the samples so far
+//*******************************************************************************
+unsigned int median_filter_update(median_filter_t *filter, unsigned int sample)
+{
+    unsigned int *sorted = filter->sorted;
+    unsigned int pos;
+
+    if (filter->count < filter->size)
+    {
+        // window not full yet, the sample goes in at the end and moves down
+        pos = filter->count++;
+    }
+    else
+    {
+        // binary search for a copy of the oldest sample, which leaves the
+        // window and makes room for the new one
+        unsigned int old = filter->ring[filter->oldest];
+        unsigned int low = 0;
+        unsigned int high = filter->count - 1;
+        pos = high / 2;
+        while (sorted[pos] != old)
+        {
+            if (sorted[pos] < old)
+            {
+                low = pos + 1;
+            }
+            else
+            {
+                high = pos - 1;
+            }
+            pos = (low + high) / 2;
+        }
+        // move the samples between the old and the new rank up by one
+        while (pos + 1 < filter->count && sorted[pos + 1] < sample)
+        {
+            sorted[pos] = sorted[pos + 1];
+            pos++;
+        }
+    }
+    // or down by one
+    while (pos > 0 && sorted[pos - 1] > sample)
+    {
+        sorted[pos] = sorted[pos - 1];
+        pos--;
+    }
+    sorted[pos] = sample;
+
+    filter->ring[filter->oldest] = sample;
+    if (++filter->oldest == filter->size)
+    {
+        filter->oldest = 0;
+    }
+    return sorted[filter->count / 2];
+}
+
+//******************************************************************************
+//Module Function median_of_3()
+//Returns the middle one of three values, with three min/max steps
+//*******************************************************************************
+unsigned int median_of_3(unsigned int a, unsigned int b, unsigned int c)
+{
+    // the larger of the smaller of a and b and the smaller of the rest
+    return MAX(MIN(a, b), MIN(MAX(a, b), c));
+}
+
+//******************************************************************************
+//Module Function median_of_5()
+//Returns the middle one of five values, with seven min/max steps
+//*******************************************************************************
+unsigned int median_of_5(unsigned int a, unsigned int b, unsigned int c,
+                         unsigned int d, unsigned int e)
+{
+    // the lower of the two pair minimums and the higher of the two pair
+    // maximums are below and above the median, which leaves three values
+    unsigned int low = MAX(MIN(a, b), MIN(c, d));
+    unsigned int high = MIN(MAX(a, b), MAX(c, d));
+
+    return median_of_3(low, high, e);
+}
+
+//******************************************************************************
+//Module Function spike_filter_init()
+//Sets up an empty spike filter over the last size samples, 5 for any size
+//other than 3
+//*******************************************************************************
+void spike_filter_init(spike_filter_t *filter, unsigned int size)
+{
+    filter->size = (unsigned char) (size == 3 ? 3 : 5);
+    filter->primed = 0;
+}
+
+//******************************************************************************
+//Module Function spike_filter_update()
+//Returns the median of sample and the samples before it, which drops a spike
+//of one sample for size 3 or of up to two samples for size 5. The first sample
+//is taken as the samples before it, without a ramp up
+//*******************************************************************************
+unsigned int spike_filter_update(spike_filter_t *filter, unsigned int sample)
+{
+    unsigned int *history = filter->history;
+    unsigned int median;
+
+    if (!filter->primed)
+    {
+        history[0] = history[1] = history[2] = history[3] = sample;
+        filter->primed = 1;
+        return sample;
+    }
+    if (filter->size == 3)
+    {
+        median = median_of_3(sample, history[0], history[1]);
+    }
+    else
+    {
+        median = median_of_5(sample, history[0], history[1], history[2],
+                             history[3]);
+    }
+    history[3] = history[2];
+    history[2] = history[1];
+    history[1] = history[0];
+    history[0] = sample;
+    return median;
+}
+
+//******************************************************************************
+//Module Function ema_filter_init()
+//Sets up an empty EMA filter giving each new sample a weight of 1/2^shift,
+//shift 0 to EMA_SHIFT_MAX. Shift 3 is about the old weight of 10
+//*******************************************************************************
+void ema_filter_init(ema_filter_t *filter, unsigned int shift)
+{
+    filter->sum = 0;
+    filter->shift = (unsigned char) (shift > EMA_SHIFT_MAX ? EMA_SHIFT_MAX : shift);
+    filter->primed = 0;
+}
+
+//******************************************************************************
+//Module Function ema_filter_update()
+//Adds sample to the average and returns the average rounded to the nearest
+//integer. The first sample is taken as the average so far, without a ramp up
+//*******************************************************************************
+unsigned int ema_filter_update(ema_filter_t *filter, unsigned int sample)
+{
+    unsigned char shift = filter->shift;
+    unsigned long half = shift ? 1UL << (shift - 1) : 0;
+
+    if (!filter->primed)
+    {
+        filter->sum = (unsigned long) sample << shift;
+        filter->primed = 1;
+        return sample;
+    }
+    // sum += sample - average, with the average rounded the same way as the
+    // result, so the sum settles where the result is the input exactly
+    filter->sum -= (filter->sum + half) >> shift;
+    filter->sum += sample;
+    return (unsigned int) ((filter->sum + half) >> shift);
+}
+
+//******************************************************************************
+//Module Function deadband_filter_init()
+//Sets up an empty deadband filter, band 0 or 1 passes every change
+//*******************************************************************************
+void deadband_filter_init(deadband_filter_t *filter, unsigned int band)
+{
+    filter->band = band;
+    filter->value = 0;
+    filter->primed = 0;
+}
+
+//******************************************************************************
+//Module Function deadband_filter_update()
+//Returns sample if it is band or more away from the value held, which it then
+//holds, or else the value held. The first sample is always taken
+//*******************************************************************************
+unsigned int deadband_filter_update(deadband_filter_t *filter,
+                                    unsigned int sample)
+{
+    unsigned int change;
+
+    // unsigned difference both ways, value - band could wrap around
+    change = (sample > filter->value) ? sample - filter->value
+                                      : filter->value - sample;
+    if (!filter->primed || change >= filter->band)
+    {
+        filter->value = sample;
+        filter->primed = 1;
+    }
+    return filter->value;
+}
+
+//******************************************************************************
+//Module Function cic_filter_init()
+//Sets up an empty CIC decimator of order 1 to CIC_ORDER_MAX giving one output
+//for every 2^ratio_shift samples. Order 1 is a boxcar average of the samples
+//since the last output. order * ratio_shift is cut down to CIC_GROWTH_MAX
+//*******************************************************************************
+void cic_filter_init(cic_filter_t *filter, unsigned int order,
+                     unsigned int ratio_shift)
+{
+    unsigned char stage;
+
+    if (order < 1)
+    {
+        order = 1;
+    }
+    if (order > CIC_ORDER_MAX)
+    {
+        order = CIC_ORDER_MAX;
+    }
+    if (ratio_shift > CIC_RATIO_SHIFT_MAX)
+    {
+        ratio_shift = CIC_RATIO_SHIFT_MAX;
+    }
+    if (order * ratio_shift > CIC_GROWTH_MAX)
+    {
+        ratio_shift = CIC_GROWTH_MAX / order;
+    }
+    for (stage = 0; stage < CIC_ORDER_MAX; stage++)
+    {
+        filter->integrator[stage] = 0;
+        filter->comb[stage] = 0;
+    }
+    filter->order = (unsigned char) order;
+    filter->ratio_shift = (unsigned char) ratio_shift;
+    filter->count = 0;
+    // the first order - 1 outputs still see the zeros the stages started with
+    filter->settling = (unsigned char) (order - 1);
+}
+
+//******************************************************************************
+//Module Function cic_filter_update()
+//Adds sample to the decimator and returns 1 with the average in output when an
+//output is due, or else 0 with output untouched. Outputs are on the scale of
+//the samples. The first output comes after order * 2^ratio_shift samples,
+//once every stage is filled with real samples
+//*******************************************************************************
+unsigned int cic_filter_update(cic_filter_t *filter, unsigned int sample,
+                               unsigned int *output)
+{
+    unsigned long value = sample;
+    unsigned long previous;
+    unsigned char stage;
+    unsigned char growth;
+
+    for (stage = 0; stage < filter->order; stage++)
+    {
+        filter->integrator[stage] += value;
+        value = filter->integrator[stage];
+    }
+    if (++filter->count < (1U << filter->ratio_shift))
+    {
+        return 0;
+    }
+    filter->count = 0;
+
+    for (stage = 0; stage < filter->order; stage++)
+    {
+        previous = filter->comb[stage];
+        filter->comb[stage] = value;
+        value -= previous;
+    }
+    if (filter->settling)
+    {
+        filter->settling--;
+        return 0;
+    }
+    // the gain of the stages is 2^(order * ratio_shift), rounded off
+    growth = filter->order * filter->ratio_shift;
+    *output = (unsigned int) ((value + ((1UL << growth) >> 1)) >> growth);
+    return 1;
+}
+
+//******************************************************************************
+//Module Function track_filter_init()
+//Sets up an empty tracker. alpha_shift 1 and beta_shift 3 follow a step in
+//about 4 updates and overshoot it by about 10%, a larger beta_shift overshoots
+//less and follows the rate more slowly. Gate 0 takes every sample
+//*******************************************************************************
+void track_filter_init(track_filter_t *filter, unsigned int alpha_shift,
+                       unsigned int beta_shift, unsigned int gate)
+{
+    filter->value = 0;
+    filter->rate = 0;
+    filter->gate = gate;
+    filter->alpha_shift = (unsigned char) (alpha_shift > 15 ? 15 : alpha_shift);
+    filter->beta_shift = (unsigned char) (beta_shift > 15 ? 15 : beta_shift);
+    filter->misses = 0;
+    filter->primed = 0;
+}
+
+//******************************************************************************
+//Module Function track_filter_update()
+//Predicts the value from the last estimate and rate, corrects both with sample
+//and returns the estimate rounded to the nearest integer. A sample further than
+//gate from the prediction only advances the prediction, unless it is the
+//TRACK_MISSES_MAX'th such sample in a row, when the tracker starts over from
+//it. The first sample is taken as the estimate, without a ramp up
+//*******************************************************************************
+int track_filter_update(track_filter_t *filter, int sample)
+{
+    // multiplied, as a left shift of a negative sample is undefined
+    long measured = (long) sample * TRACK_RATE_SCALE;
+    long predicted = filter->value + filter->rate;
+    long innovation = measured - predicted;
+    long gate = (long) filter->gate << TRACK_FRACTION_BITS;
+
+    if (filter->primed && filter->gate
+            && (innovation > gate || innovation < -gate))
+    {
+        if (++filter->misses < TRACK_MISSES_MAX)
+        {
+            filter->value = predicted; // outlier, coast on the prediction
+        }
+        else
+        {
+            // the outliers have kept coming, they are the value now
+            filter->value = measured;
+            filter->rate = 0;
+            filter->misses = 0;
+        }
+    }
+    else if (!filter->primed)
+    {
+        filter->value = measured;
+        filter->primed = 1;
+    }
+    else
+    {
+        filter->value = predicted + (innovation >> filter->alpha_shift);
+        filter->rate += innovation >> filter->beta_shift;
+        filter->misses = 0;
+    }
+    return (int) ((filter->value + (1L << (TRACK_FRACTION_BITS - 1)))
+                  >> TRACK_FRACTION_BITS);
+}
+
+//******************************************************************************
+//Module Function track_filter_rate()
+//Returns the rate of change the tracker estimates, in 1/TRACK_RATE_SCALE of a
+//sample per update
+//*******************************************************************************
+int track_filter_rate(const track_filter_t *filter)
+{
+    return (int) filter->rate;
+}
+
+//******************************************************************************
+//Module Function channel_stats_reset()
+//Empties the statistics window, the next sample starts a new one
+//*******************************************************************************
+void channel_stats_reset(channel_stats_t *stats)
+{
+    stats->sum = 0;
+    stats->sum_squares = 0;
+    stats->offset = 0;
+    stats->min = 0;
+    stats->max = 0;
+    stats->count = 0;
+}
+
+//******************************************************************************
+//Module Function channel_stats_update()
+//Adds sample to the window. Samples past STATS_COUNT_MAX are left out until
+//the next reset. Samples have to stay within 4095 of the first one
+//*******************************************************************************
+void channel_stats_update(channel_stats_t *stats, unsigned int sample)
+{
+    int deviation;
+
+    if (stats->count >= STATS_COUNT_MAX)
+    {
+        return;
+    }
+    if (!stats->count)
+    {
+        stats->offset = stats->min = stats->max = sample;
+    }
+    else if (sample < stats->min)
+    {
+        stats->min = sample;
+    }
+    else if (sample > stats->max)
+    {
+        stats->max = sample;
+    }
+    deviation = (int) (sample - stats->offset);
+    stats->sum += deviation;
+    stats->sum_squares += (unsigned long) ((long) deviation * deviation);
+    stats->count++;
+}
+
+//******************************************************************************
+//Module Function channel_stats_mean()
+//Returns the mean of the window rounded to the nearest integer, 0 if empty
+//*******************************************************************************
+unsigned int channel_stats_mean(const channel_stats_t *stats)
+{
+    long half = stats->count / 2;
+
+    if (!stats->count)
+    {
+        return 0;
+    }
+    // rounds away from 0 both ways, the division truncates towards 0
+    return stats->offset + (int) ((stats->sum + (stats->sum < 0 ? -half : half))
+                                  / (long) stats->count);
+}
+
+//******************************************************************************
+//Module Function channel_stats_variance()
+//Returns the population variance of the window rounded down, 0 if empty
+//*******************************************************************************
+unsigned long channel_stats_variance(const channel_stats_t *stats)
+{
+    unsigned long sum;
+    unsigned long quotient;
+    unsigned long remainder;
+
+    if (!stats->count)
+    {
+        return 0;
+    }
+    // (sum of squares - sum^2 / n) / n. sum^2 needs up to 40 bits, but with
+    // sum = q * n + r, sum^2 / n is q * sum + r * sum / n, and both products
+    // fit in 32 bits for STATS_COUNT_MAX samples within 4095 of the first one
+    // sum^2 / n is rounded up, so the variance comes out rounded down
+    sum = (stats->sum < 0) ? 0UL - (unsigned long) stats->sum
+                           : (unsigned long) stats->sum;
+    quotient = sum / stats->count;
+    remainder = sum % stats->count;
+    return (stats->sum_squares - quotient * sum
+            - (remainder * sum + stats->count - 1) / stats->count)
+            / stats->count;
+}
+
+//******************************************************************************
+//Module Function filter_pipeline_update()
+//Runs sample through count stages, each one taking the output of the one
+//before, and returns the output of the last stage
+//*******************************************************************************
+unsigned int filter_pipeline_update(const filter_stage_t *stages,
+                                    unsigned int count, unsigned int sample)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        switch (stages[i].kind)
+        {
+        case FILTER_MEDIAN:
+            sample = median_filter_update(stages[i].state, sample);
+            break;
+        case FILTER_SPIKE:
+            sample = spike_filter_update(stages[i].state, sample);
+            break;
+        case FILTER_EMA:
+            sample = ema_filter_update(stages[i].state, sample);
+            break;
+        case FILTER_DEADBAND:
+            sample = deadband_filter_update(stages[i].state, sample);
+            break;
+        default:
+            break;
+        }
+    }
+    return sample;
+}
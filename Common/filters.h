@@ -0,0 +1,283 @@
+/*
+ *  filters.h
+ *  Streaming filters for ADC samples shared by the projects
+ *  Each filter keeps its state in a struct owned by the caller and takes one
+ *  sample per update, giving one filtered value per sample. Filters are chained
+ *  per channel with a const table of stages run by filter_pipeline_update()
+ */
+
+#ifndef FILTERS_H_
+#define FILTERS_H_
+
+// longest median window, odd windows have a true middle sample
+#define MEDIAN_WINDOW_MAX 31
+
+// largest EMA shift, each new sample then weighs 1/32768
+#define EMA_SHIFT_MAX 15
+
+// most integrator and comb stages of a CIC decimator, each stage takes 8 bytes
+// of RAM in every cic_filter_t
+#define CIC_ORDER_MAX 2
+// largest CIC ratio shift, one output for every 128 samples
+#define CIC_RATIO_SHIFT_MAX 7
+// order * ratio shift the 32 bit stages have room for above a 16 bit sample
+#define CIC_GROWTH_MAX 16
+
+// fraction bits the tracker keeps its estimates with
+#define TRACK_FRACTION_BITS 4
+// track_filter_rate() is in 1/TRACK_RATE_SCALE of a sample per update
+#define TRACK_RATE_SCALE (1 << TRACK_FRACTION_BITS)
+// samples in a row outside the gate before the tracker takes them as a real
+// jump and starts over from the newest one
+#define TRACK_MISSES_MAX 2
+
+// most samples in a statistics window, the sum of squares of up to this many
+// samples 4095 away from the first one just fits in 32 bits
+#define STATS_COUNT_MAX 256
+
+// sliding window median, the window is kept both in arrival order and sorted
+typedef struct
+{
+    unsigned int *ring; // samples in arrival order, size entries
+    unsigned int *sorted; // the same samples sorted, size entries
+    unsigned char size; // samples in a full window
+    unsigned char count; // samples in the window so far
+    unsigned char oldest; // index in ring of the oldest sample
+} median_filter_t;
+
+// median of the last 3 or 5 samples by a min/max network, for rejecting
+// single spikes at the full sample rate
+typedef struct
+{
+    unsigned int history[4]; // samples before the newest, newest first
+    unsigned char size; // 3 or 5
+    unsigned char primed; // set once the first sample is in
+} spike_filter_t;
+
+// exponential moving average with a weight of 1/2^shift for each new sample
+typedef struct
+{
+    unsigned long sum; // average times 2^shift, keeps the fraction
+    unsigned char shift;
+    unsigned char primed; // set once the first sample is in
+} ema_filter_t;
+
+// holds its output until the input moves band or more away from it
+typedef struct
+{
+    unsigned int band;
+    unsigned int value; // output held
+    unsigned char primed; // set once the first sample is in
+} deadband_filter_t;
+
+// CIC decimator, order integrators at the sample rate and order combs at the
+// output rate, one output for every 2^ratio_shift samples. The stages wrap
+// around modulo 2^32, which the combs undo as long as the output fits
+typedef struct
+{
+    unsigned long integrator[CIC_ORDER_MAX];
+    unsigned long comb[CIC_ORDER_MAX]; // comb inputs of the last output
+    unsigned char order;
+    unsigned char ratio_shift;
+    unsigned char count; // samples since the last output
+    unsigned char settling; // outputs still to drop while the stages fill up
+} cic_filter_t;
+
+// alpha-beta tracker of a value and its rate of change, with gains of
+// 1/2^alpha_shift and 1/2^beta_shift. Samples further than gate from where the
+// value is headed are dropped as outliers
+typedef struct
+{
+    long value; // estimate times 2^TRACK_FRACTION_BITS
+    long rate; // change per update times 2^TRACK_FRACTION_BITS
+    unsigned int gate;
+    unsigned char alpha_shift;
+    unsigned char beta_shift;
+    unsigned char misses; // samples in a row outside the gate
+    unsigned char primed; // set once the first sample is in
+} track_filter_t;
+
+// count, min, max, mean and variance of the samples since the last reset. The
+// sums are of the samples less the first one, which keeps them exact in
+// integers and small for a steady input
+typedef struct
+{
+    long sum; // of sample - offset
+    unsigned long sum_squares; // of (sample - offset)^2
+    unsigned int offset; // first sample of the window
+    unsigned int min;
+    unsigned int max;
+    unsigned int count;
+} channel_stats_t;
+
+// kinds of stage a filter pipeline is made of
+typedef enum
+{
+    FILTER_MEDIAN, // state is a median_filter_t
+    FILTER_SPIKE, // state is a spike_filter_t
+    FILTER_EMA, // state is an ema_filter_t
+    FILTER_DEADBAND // state is a deadband_filter_t
+} FILTER_KIND;
+
+// one stage of a filter pipeline, pipelines are meant to be const tables with
+// one table per channel
+typedef struct
+{
+    FILTER_KIND kind;
+    void *state; // filter of the kind, set up by its init function
+} filter_stage_t;
+
+// number of stages in a const table of filter_stage_t
+#define FILTER_STAGES(stages) (sizeof(stages) / sizeof((stages)[0]))
+
+//******************************************************************************
+//Module Function median_filter_init()
+//Sets up an empty median filter of size samples, 1 to MEDIAN_WINDOW_MAX, over
+//the caller's ring and sorted arrays of size entries each
+//*******************************************************************************
+void median_filter_init(median_filter_t *filter, unsigned int *ring,
+                        unsigned int *sorted, unsigned int size);
+
+//******************************************************************************
+//Module Function median_filter_update()
+//Puts sample in the window in place of the oldest one and returns the median
+//of the window, the upper one of the two middle samples for even windows
+//Until the window is full the median is of the samples so far
+//*******************************************************************************
+unsigned int median_filter_update(median_filter_t *filter, unsigned int sample);
+
+//******************************************************************************
+//Module Function median_of_3()
+//Returns the middle one of three values, with three min/max steps
+//*******************************************************************************
+unsigned int median_of_3(unsigned int a, unsigned int b, unsigned int c);
+
+//******************************************************************************
+//Module Function median_of_5()
+//Returns the middle one of five values, with seven min/max steps
+//*******************************************************************************
+unsigned int median_of_5(unsigned int a, unsigned int b, unsigned int c,
+                         unsigned int d, unsigned int e);
+
+//******************************************************************************
+//Module Function spike_filter_init()
+//Sets up an empty spike filter over the last size samples, 5 for any size
+//other than 3
+//*******************************************************************************
+void spike_filter_init(spike_filter_t *filter, unsigned int size);
+
+//******************************************************************************
+//Module Function spike_filter_update()
+//Returns the median of sample and the samples before it, which drops a spike
+//of one sample for size 3 or of up to two samples for size 5. The first sample
+//is taken as the samples before it, without a ramp up
+//*******************************************************************************
+unsigned int spike_filter_update(spike_filter_t *filter, unsigned int sample);
+
+//******************************************************************************
+//Module Function ema_filter_init()
+//Sets up an empty EMA filter giving each new sample a weight of 1/2^shift,
+//shift 0 to EMA_SHIFT_MAX. Shift 3 is about the old weight of 10
+//*******************************************************************************
+void ema_filter_init(ema_filter_t *filter, unsigned int shift);
+
+//******************************************************************************
+//Module Function ema_filter_update()
+//Adds sample to the average and returns the average rounded to the nearest
+//integer. The first sample is taken as the average so far, without a ramp up
+//*******************************************************************************
+unsigned int ema_filter_update(ema_filter_t *filter, unsigned int sample);
+
+//******************************************************************************
+//Module Function deadband_filter_init()
+//Sets up an empty deadband filter, band 0 or 1 passes every change
+//*******************************************************************************
+void deadband_filter_init(deadband_filter_t *filter, unsigned int band);
+
+//******************************************************************************
+//Module Function deadband_filter_update()
+//Returns sample if it is band or more away from the value held, which it then
+//holds, or else the value held. The first sample is always taken
+//*******************************************************************************
+unsigned int deadband_filter_update(deadband_filter_t *filter,
+                                    unsigned int sample);
+
+//******************************************************************************
+//Module Function cic_filter_init()
+//Sets up an empty CIC decimator of order 1 to CIC_ORDER_MAX giving one output
+//for every 2^ratio_shift samples. Order 1 is a boxcar average of the samples
+//since the last output. order * ratio_shift is cut down to CIC_GROWTH_MAX
+//*******************************************************************************
+void cic_filter_init(cic_filter_t *filter, unsigned int order,
+                     unsigned int ratio_shift);
+
+//******************************************************************************
+//Module Function cic_filter_update()
+//Adds sample to the decimator and returns 1 with the average in output when an
+//output is due, or else 0 with output untouched. Outputs are on the scale of
+//the samples. The first output comes after order * 2^ratio_shift samples,
+//once every stage is filled with real samples
+//*******************************************************************************
+unsigned int cic_filter_update(cic_filter_t *filter, unsigned int sample,
+                               unsigned int *output);
+
+//******************************************************************************
+//Module Function track_filter_init()
+//Sets up an empty tracker. alpha_shift 1 and beta_shift 3 follow a step in
+//about 4 updates and overshoot it by about 10%, a larger beta_shift overshoots
+//less and follows the rate more slowly. Gate 0 takes every sample
+//*******************************************************************************
+void track_filter_init(track_filter_t *filter, unsigned int alpha_shift,
+                       unsigned int beta_shift, unsigned int gate);
+
+//******************************************************************************
+//Module Function track_filter_update()
+//Predicts the value from the last estimate and rate, corrects both with sample
+//and returns the estimate rounded to the nearest integer. A sample further than
+//gate from the prediction only advances the prediction, unless it is the
+//TRACK_MISSES_MAX'th such sample in a row, when the tracker starts over from
+//it. The first sample is taken as the estimate, without a ramp up
+//*******************************************************************************
+int track_filter_update(track_filter_t *filter, int sample);
+
+//******************************************************************************
+//Module Function track_filter_rate()
+//Returns the rate of change the tracker estimates, in 1/TRACK_RATE_SCALE of a
+//sample per update
+//*******************************************************************************
+int track_filter_rate(const track_filter_t *filter);
+
+//******************************************************************************
+//Module Function channel_stats_reset()
+//Empties the statistics window, the next sample starts a new one
+//*******************************************************************************
+void channel_stats_reset(channel_stats_t *stats);
+
+//******************************************************************************
+//Module Function channel_stats_update()
+//Adds sample to the window. Samples past STATS_COUNT_MAX are left out until
+//the next reset. Samples have to stay within 4095 of the first one
+//*******************************************************************************
+void channel_stats_update(channel_stats_t *stats, unsigned int sample);
+
+//******************************************************************************
+//Module Function channel_stats_mean()
+//Returns the mean of the window rounded to the nearest integer, 0 if empty
+//*******************************************************************************
+unsigned int channel_stats_mean(const channel_stats_t *stats);
+
+//******************************************************************************
+//Module Function channel_stats_variance()
+//Returns the population variance of the window rounded down, 0 if empty
+//*******************************************************************************
+unsigned long channel_stats_variance(const channel_stats_t *stats);
+
+//******************************************************************************
+//Module Function filter_pipeline_update()
+//Runs sample through count stages, each one taking the output of the one
+//before, and returns the output of the last stage
+//*******************************************************************************
+unsigned int filter_pipeline_update(const filter_stage_t *stages,
+                                    unsigned int count, unsigned int sample);
+
+#endif /* FILTERS_H_ */
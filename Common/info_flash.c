@@ -0,0 +1,87 @@
+/*
+ *  info_flash.c
+ *  Calibration values kept in the information memory of the MSP430
+ *  The header holds the count of values, so a record stored by a build with
+ *  more or fewer values is not taken, and the checksum makes header, values
+ *  and checksum add up to 0. An erased segment reads 0xFFFF everywhere, which
+ *  is never a valid header
+ */
+
+#include <msp430.h>
+#include "info_flash.h"
+
+// header word of a record of count values
+#define RECORD_HEADER(count) (0xCA00 | (count))
+
+// flash timing generator from MCLK / 3, 333 kHz at 1 MHz, within the 257 to
+// 476 kHz the flash needs
+#define FLASH_CLOCK (FSSEL_1 + FN1)
+
+//******************************************************************************
+//Module Function info_flash_load()
+//Copies the count values of the record to words and returns 1, or leaves
+//words as they are and returns 0 when the segment is erased, the checksum is
+//wrong or the record was stored with another count. Reads only, no waiting
+//*******************************************************************************
+unsigned int info_flash_load(unsigned int *words, unsigned int count)
+{
+    const unsigned int *record = (const unsigned int *) INFO_FLASH_SEGMENT;
+    unsigned int sum;
+    unsigned int i;
+
+    if (count > INFO_FLASH_WORDS_MAX || record[0] != RECORD_HEADER(count))
+    {
+        return 0;
+    }
+    sum = record[0] + record[count + 1];
+    for (i = 0; i < count; i++)
+    {
+        sum += record[i + 1];
+    }
+    if (sum != 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        words[i] = record[i + 1];
+    }
+    return 1;
+}
+
+//******************************************************************************
+//Module Function info_flash_store()
+//Erases the segment and writes count values, up to INFO_FLASH_WORDS_MAX, as a
+//new record. Takes about 20 ms with interrupts off and needs MCLK at 1 MHz for
+//the flash timing. Does nothing when count is too big
+//*******************************************************************************
+void info_flash_store(const unsigned int *words, unsigned int count)
+{
+    unsigned int *record = (unsigned int *) INFO_FLASH_SEGMENT;
+    unsigned int interrupts = __get_SR_register() & GIE;
+    unsigned int sum = RECORD_HEADER(count);
+    unsigned int i;
+
+    if (count > INFO_FLASH_WORDS_MAX)
+    {
+        return;
+    }
+    // the interrupt vectors are in flash too, nothing may be fetched from it
+    // while it is erased or written. The CPU is held until each step is done
+    __disable_interrupt();
+    FCTL2 = FWKEY + FLASH_CLOCK;
+    FCTL3 = FWKEY; // unlock, segment A stays locked by LOCKA
+    FCTL1 = FWKEY + ERASE;
+    *record = 0; // a dummy write to the segment erases it
+    FCTL1 = FWKEY + WRT;
+    record[0] = RECORD_HEADER(count);
+    for (i = 0; i < count; i++)
+    {
+        record[i + 1] = words[i];
+        sum += words[i];
+    }
+    record[count + 1] = -sum;
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY + LOCK;
+    __bis_SR_register(interrupts);
+}
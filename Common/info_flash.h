@@ -0,0 +1,38 @@
+/*
+ *  info_flash.h
+ *  Calibration values kept in the information memory of the MSP430, so they
+ *  survive a reset or a power cycle and each board keeps its own
+ *  A record is a header word, the values and a checksum word, all in one
+ *  segment. Segment A holds the factory DCO and ADC calibration and is never
+ *  written
+ */
+
+#ifndef INFO_FLASH_H_
+#define INFO_FLASH_H_
+
+// information memory segment the record is kept in, segment C. B and D are
+// left for anything else
+#define INFO_FLASH_SEGMENT 0x1040
+#define INFO_FLASH_SEGMENT_SIZE 64
+
+// values a record holds, what is left of the segment after the header and the
+// checksum
+#define INFO_FLASH_WORDS_MAX (INFO_FLASH_SEGMENT_SIZE / 2 - 2)
+
+//******************************************************************************
+//Module Function info_flash_load()
+//Copies the count values of the record to words and returns 1, or leaves
+//words as they are and returns 0 when the segment is erased, the checksum is
+//wrong or the record was stored with another count. Reads only, no waiting
+//*******************************************************************************
+unsigned int info_flash_load(unsigned int *words, unsigned int count);
+
+//******************************************************************************
+//Module Function info_flash_store()
+//Erases the segment and writes count values, up to INFO_FLASH_WORDS_MAX, as a
+//new record. Takes about 20 ms with interrupts off and needs MCLK at 1 MHz for
+//the flash timing. Does nothing when count is too big
+//*******************************************************************************
+void info_flash_store(const unsigned int *words, unsigned int count);
+
+#endif /* INFO_FLASH_H_ */
@@ -0,0 +1,630 @@
+/*
+ *  quad_led.c
+ *  Multiplexed quad digit 7-segment LED display shared by the projects
+ *  All port masks are generated at compile time from the project's led_pins.h,
+ *  so drawing a digit is a single write per port with no lookups of the pins
+ */
+
+#include <msp430.h>
+#include "led_pins.h"
+#include "quad_led.h"
+
+// mask of a segment on the given port, 0 if the segment is on the other port
+#define SEG_MASK(seg, port) \
+    ((LED_SEG_##seg##_PORT == (port)) ? LED_SEG_##seg##_PIN : 0)
+
+#ifdef LED_SEG_DP_PIN
+#define DP_MASK(port) SEG_MASK(DP, port)
+#else
+#define DP_MASK(port) 0
+#endif
+
+// all segment pins on each port, including the decimal point
+#define SEGMENTS_ON_PORT(port)                                           \
+    (SEG_MASK(A, port) | SEG_MASK(B, port) | SEG_MASK(C, port)           \
+     | SEG_MASK(D, port) | SEG_MASK(E, port) | SEG_MASK(F, port)         \
+     | SEG_MASK(G, port) | DP_MASK(port))
+#define P1_SEGMENTS SEGMENTS_ON_PORT(1)
+#define P2_SEGMENTS SEGMENTS_ON_PORT(2)
+
+#define ALL_DIGITS (LED_DIGIT_1 | LED_DIGIT_2 | LED_DIGIT_3 | LED_DIGIT_4)
+
+// Timer_A instance used for refreshing the display
+#if LED_REFRESH_TIMER == 1
+#define REFRESH_TCTL TA1CTL
+#define REFRESH_TCCR0 TA1CCR0
+#define REFRESH_TCCTL0 TA1CCTL0
+#define REFRESH_VECTOR TIMER1_A0_VECTOR
+#else
+#define REFRESH_TCTL TA0CTL
+#define REFRESH_TCCR0 TA0CCR0
+#define REFRESH_TCCTL0 TA0CCTL0
+#define REFRESH_VECTOR TIMER0_A0_VECTOR
+#endif
+
+// Port masks of the segments to light for one glyph. Segments are active low,
+// so a digit is drawn by setting all segment pins and clearing the ones in the
+// mask, with a single write per port
+// Both masks share one word, port 1 in the low byte as the MSP430 is little
+// endian, so the framebuffer is written a whole glyph at a time with one word
+// store that the refresh interrupt cannot split
+typedef union
+{
+    unsigned int word;
+    struct
+    {
+        unsigned char p1; // segments on port 1
+        unsigned char p2; // segments on port 2
+    } ports;
+} led_glyph_t;
+
+// glyph word of the given port 1 and port 2 masks
+#define GLYPH_WORD(p1, p2) ((unsigned int) (p1) | ((unsigned int) (p2) << 8))
+
+// decimal point of a glyph word
+#define DP_WORD GLYPH_WORD(DP_MASK(1), DP_MASK(2))
+
+// port mask of the lit segments A-G of a glyph
+#define GLYPH_MASK(port, sa, sb, sc, sd, se, sf, sg)                     \
+    (((sa) ? SEG_MASK(A, port) : 0) | ((sb) ? SEG_MASK(B, port) : 0)     \
+     | ((sc) ? SEG_MASK(C, port) : 0) | ((sd) ? SEG_MASK(D, port) : 0)   \
+     | ((se) ? SEG_MASK(E, port) : 0) | ((sf) ? SEG_MASK(F, port) : 0)   \
+     | ((sg) ? SEG_MASK(G, port) : 0))
+
+// Builds the port masks of a glyph from its lit segments A-G at compile time
+#define LED_GLYPH(sa, sb, sc, sd, se, sf, sg)                            \
+    {                                                                    \
+        GLYPH_WORD(GLYPH_MASK(1, sa, sb, sc, sd, se, sf, sg),            \
+                   GLYPH_MASK(2, sa, sb, sc, sd, se, sf, sg))            \
+    }
+
+// glyphs indexed by LED_CHARS
+static const led_glyph_t led_glyphs[] = {
+    //        A  B  C  D  E  F  G
+    LED_GLYPH(1, 1, 1, 1, 1, 1, 0), // NUM_0
+    LED_GLYPH(0, 1, 1, 0, 0, 0, 0), // NUM_1
+    LED_GLYPH(1, 1, 0, 1, 1, 0, 1), // NUM_2
+    LED_GLYPH(1, 1, 1, 1, 0, 0, 1), // NUM_3
+    LED_GLYPH(0, 1, 1, 0, 0, 1, 1), // NUM_4
+    LED_GLYPH(1, 0, 1, 1, 0, 1, 1), // NUM_5
+    LED_GLYPH(1, 0, 1, 1, 1, 1, 1), // NUM_6
+    LED_GLYPH(1, 1, 1, 0, 0, 0, 0), // NUM_7
+    LED_GLYPH(1, 1, 1, 1, 1, 1, 1), // NUM_8
+    LED_GLYPH(1, 1, 1, 0, 0, 1, 1), // NUM_9
+    LED_GLYPH(0, 1, 1, 0, 1, 1, 1), // CHAR_X
+    LED_GLYPH(0, 1, 1, 1, 0, 1, 1), // CHAR_Y
+    LED_GLYPH(1, 1, 0, 1, 1, 0, 1), // CHAR_Z
+    LED_GLYPH(1, 0, 1, 0, 1, 1, 1), // CHAR_K
+    LED_GLYPH(0, 0, 0, 0, 0, 0, 1), // CHAR_DASH
+    LED_GLYPH(0, 0, 0, 0, 0, 0, 0), // CHAR_BLANK
+};
+
+// digit select pin of each framebuffer position, leftmost digit first
+static const unsigned char led_digit_pins[LED_DIGITS] = { LED_DIGIT_1,
+                                                          LED_DIGIT_2,
+                                                          LED_DIGIT_3,
+                                                          LED_DIGIT_4 };
+
+// SMCLK cycles each digit is lit for at each brightness level, the rest of
+// the LED_DIGIT_CYCLES of the digit it is off, so the refresh rate stays the
+// same at all levels
+static const unsigned int digit_on_cycles[QUAD_LED_BRIGHTNESS_LEVELS] = {
+    LED_DIGIT_CYCLES / 8,
+    LED_DIGIT_CYCLES / 4,
+    LED_DIGIT_CYCLES / 2,
+    LED_DIGIT_CYCLES
+};
+
+// segments to show on each digit, scanned out one digit per timer interrupt
+static volatile led_glyph_t led_frame[LED_DIGITS];
+static volatile unsigned char current_digit = 0;
+static volatile unsigned int frames_left = 0;
+static volatile unsigned char brightness = QUAD_LED_BRIGHTNESS_MAX;
+static volatile unsigned char digit_lit = 0;
+
+// numbers played one after the other by the refresh interrupt, see
+// quad_led_play_numbers()
+static const unsigned int *volatile sequence_numbers;
+static volatile unsigned int sequence_left = 0;
+static volatile unsigned int sequence_frames = 0;
+static unsigned int sequence_frames_each = 0;
+
+// place value of each digit, leftmost digit first
+static const unsigned int powers_of_ten[LED_DIGITS - 1] = { 1000, 100, 10 };
+
+// last number given to quad_led_show_number and its decimal digits
+static unsigned int cached_value = 0;
+static unsigned char cached_digits[LED_DIGITS] = { 0 };
+
+// what the framebuffer was last filled with, so showing the same thing again
+// leaves the port masks already in the framebuffer as they are
+typedef enum
+{
+    FRAME_CHARS, // set a character at a time, always rendered again
+    FRAME_NUMBER, // quad_led_show_number() of frame_value
+    FRAME_SIGNED, // quad_led_show_signed() of frame_value
+    FRAME_FIELDS // quad_led_show_fields() of frame_fields and frame_field_values
+} FRAME_CONTENTS;
+
+static FRAME_CONTENTS frame_contents = FRAME_CHARS;
+static unsigned int frame_value = 0;
+static unsigned int frame_dp_pos = QUAD_LED_NO_DP;
+static const led_field_t *frame_fields = 0;
+static int frame_field_values[LED_DIGITS];
+
+#ifdef __MSP430__
+// fails to compile when QUAD_LED_RAM no longer adds up to the statics above
+typedef char quad_led_ram_check[(sizeof(led_frame) + sizeof(current_digit)
+        + sizeof(frames_left) + sizeof(brightness) + sizeof(digit_lit)
+        + sizeof(sequence_numbers) + sizeof(sequence_left)
+        + sizeof(sequence_frames) + sizeof(sequence_frames_each)
+        + sizeof(cached_value) + sizeof(cached_digits) + sizeof(frame_contents)
+        + sizeof(frame_value) + sizeof(frame_dp_pos) + sizeof(frame_fields)
+        + sizeof(frame_field_values) == QUAD_LED_RAM) ? 1 : -1];
+#endif
+
+//******************************************************************************
+//Module Function quad_led_init()
+//Sets the digit and segment pins in led_pins.h as outputs, clears the display
+//and starts the timer that refreshes it. Interrupts need to be enabled
+//*******************************************************************************
+void quad_led_init(void)
+{
+    // p2.6 and p2.7 are not gpio by default
+    P2SEL &= (unsigned char)~(ALL_DIGITS | P2_SEGMENTS);
+    P2SEL2 &= (unsigned char)~(ALL_DIGITS | P2_SEGMENTS);
+    P2DIR |= ALL_DIGITS | P2_SEGMENTS;
+    P1DIR |= P1_SEGMENTS;
+    // all digits and segments off by default
+    P2OUT &= ~ALL_DIGITS;
+    P2OUT |= P2_SEGMENTS;
+    P1OUT |= P1_SEGMENTS;
+    quad_led_clear();
+    // one digit every LED_DIGIT_CYCLES of SMCLK
+    REFRESH_TCCR0 = LED_DIGIT_CYCLES - 1;
+    REFRESH_TCCTL0 = CCIE;
+    REFRESH_TCTL = TASSEL_2 | MC_1 | TACLR;
+}
+
+//******************************************************************************
+//Module Function quad_led_clear()
+//Blanks all digits of the framebuffer
+//*******************************************************************************
+void quad_led_clear(void)
+{
+    unsigned int pos;
+    sequence_left = 0;
+    frame_contents = FRAME_CHARS;
+    for (pos = 0; pos < LED_DIGITS; pos++)
+    {
+        led_frame[pos].word = led_glyphs[CHAR_BLANK].word;
+    }
+}
+
+//******************************************************************************
+//Module Function quad_led_glyph()
+//Returns the port masks of a character, with its decimal point lit if dp is set
+//*******************************************************************************
+static led_glyph_t quad_led_glyph(LED_CHARS led_char, unsigned char dp)
+{
+    led_glyph_t glyph =
+            led_glyphs[((unsigned int) led_char <= CHAR_BLANK) ? led_char : CHAR_DASH];
+    if (dp)
+    {
+        glyph.word |= DP_WORD;
+    }
+    return glyph;
+}
+
+//******************************************************************************
+//Module Function quad_led_put()
+//Writes a character and its decimal point to a digit of the framebuffer as one
+//word store, so the refresh interrupt never shows the port 1 segments of one
+//glyph with the port 2 segments of another
+//*******************************************************************************
+static void quad_led_put(unsigned int pos, LED_CHARS led_char, unsigned char dp)
+{
+    led_frame[pos].word = quad_led_glyph(led_char, dp).word;
+}
+
+//******************************************************************************
+//Module Function quad_led_set_char()
+//Puts a character in the framebuffer, pos 0 is the leftmost digit
+//*******************************************************************************
+void quad_led_set_char(unsigned int pos, LED_CHARS led_char)
+{
+    sequence_left = 0;
+    frame_contents = FRAME_CHARS;
+    quad_led_put(pos, led_char, 0);
+}
+
+//******************************************************************************
+//Module Function quad_led_set_char_dp()
+//Puts a character with its decimal point lit in the framebuffer
+//*******************************************************************************
+void quad_led_set_char_dp(unsigned int pos, LED_CHARS led_char)
+{
+    sequence_left = 0;
+    frame_contents = FRAME_CHARS;
+    quad_led_put(pos, led_char, 1);
+}
+
+//******************************************************************************
+//Module Function quad_led_set_dp()
+//Lights the decimal point of a digit of the framebuffer, until the character of
+//that digit is set again. Does nothing if led_pins.h has no decimal point
+//*******************************************************************************
+void quad_led_set_dp(unsigned int pos)
+{
+    sequence_left = 0;
+    frame_contents = FRAME_CHARS;
+    led_frame[pos].word |= DP_WORD;
+}
+
+//******************************************************************************
+//Module Function quad_led_to_digits()
+//Splits a number up to 9999 into its decimal digits, most significant first,
+//by subtracting powers of ten. The G2553 has no hardware divider, so this is
+//much cheaper than a division and a modulo per digit
+//*******************************************************************************
+static void quad_led_to_digits(unsigned int val, unsigned char *digits)
+{
+    unsigned int pos;
+    for (pos = 0; pos < LED_DIGITS - 1; pos++)
+    {
+        unsigned char digit = 0;
+        while (val >= powers_of_ten[pos])
+        {
+            val -= powers_of_ten[pos];
+            digit++;
+        }
+        digits[pos] = digit;
+    }
+    // what is left is the 1s place
+    digits[LED_DIGITS - 1] = val;
+}
+
+//******************************************************************************
+//Module Function quad_led_draw_digits()
+//Puts the decimal digits of a number up to 9999 in the framebuffer with the
+//leading zeros blank, and the decimal point of digit dp_pos lit
+//*******************************************************************************
+static void quad_led_draw_digits(const unsigned char *digits, unsigned int dp_pos)
+{
+    unsigned int pos = 0;
+    // leading zeros are blank, the 1s place is always shown
+    while (pos < LED_DIGITS - 1 && digits[pos] == 0)
+    {
+        quad_led_put(pos, CHAR_BLANK, pos == dp_pos);
+        pos++;
+    }
+    while (pos < LED_DIGITS)
+    {
+        quad_led_put(pos, digits[pos], pos == dp_pos);
+        pos++;
+    }
+}
+
+//******************************************************************************
+//Module Function quad_led_show_number()
+//Puts a number in the framebuffer, right aligned, with the unused digits blank
+//Numbers above 9999 blank the whole display. Does nothing if the display
+//already shows the number, and the digits are only worked out again when the
+//number differs from the last one shown
+//*******************************************************************************
+void quad_led_show_number(unsigned int val)
+{
+    quad_led_show_number_dp(val, QUAD_LED_NO_DP);
+}
+
+//******************************************************************************
+//Module Function quad_led_show_number_dp()
+//Same as quad_led_show_number(), with the decimal point of digit dp_pos lit
+//Every digit is written once with its decimal point already in it
+//*******************************************************************************
+void quad_led_show_number_dp(unsigned int val, unsigned int dp_pos)
+{
+    unsigned int pos;
+    sequence_left = 0; // live values take over from a sequence being played
+    if (frame_contents == FRAME_NUMBER && frame_value == val
+            && frame_dp_pos == dp_pos)
+    {
+        return;
+    }
+    if (val != cached_value)
+    {
+        cached_value = val;
+        if (val <= 9999)
+        {
+            quad_led_to_digits(val, cached_digits);
+        }
+    }
+    if (val <= 9999)
+    {
+        quad_led_draw_digits(cached_digits, dp_pos);
+    }
+    else
+    {
+        for (pos = 0; pos < LED_DIGITS; pos++)
+        {
+            quad_led_put(pos, CHAR_BLANK, pos == dp_pos);
+        }
+    }
+    frame_contents = FRAME_NUMBER;
+    frame_value = val;
+    frame_dp_pos = dp_pos;
+}
+
+//******************************************************************************
+//Module Function quad_led_show_signed()
+//Puts a signed number in the framebuffer, right aligned with a '-' in front of
+//negative numbers. -999 to 9999 are shown as they are, anything bigger in
+//thousands with a k on the last digit, e.g. 12.3k, -4.5k or -32k
+//Does nothing if the display already shows the number
+//*******************************************************************************
+void quad_led_show_signed(int val)
+{
+    unsigned int mag = (val < 0) ? 0u - (unsigned int) val : (unsigned int) val;
+    unsigned char digits[LED_DIGITS];
+    unsigned int pos = 0;
+    sequence_left = 0;
+    if (frame_contents == FRAME_SIGNED && frame_value == (unsigned int) val)
+    {
+        return;
+    }
+    if (val >= -999 && val <= 9999)
+    {
+        quad_led_to_digits(mag, digits);
+        // leading zeros are blank, the 1s place is always shown
+        while (pos < LED_DIGITS - 1 && digits[pos] == 0)
+        {
+            quad_led_put(pos++, CHAR_BLANK, 0);
+        }
+        if (val < 0)
+        {
+            // -999 has no leading zero, its sign goes on the leftmost digit
+            quad_led_put(pos - 1, CHAR_DASH, 0);
+        }
+        while (pos < LED_DIGITS)
+        {
+            quad_led_put(pos, digits[pos], 0);
+            pos++;
+        }
+    }
+    else
+    {
+        unsigned char ten_thousands = 0;
+        while (mag >= 10000)
+        {
+            mag -= 10000;
+            ten_thousands++;
+        }
+        // digits[0] is now the thousands and digits[1] the hundreds
+        quad_led_to_digits(mag, digits);
+        if (val < 0 && ten_thousands != 0)
+        {
+            quad_led_put(0, CHAR_DASH, 0);
+            quad_led_put(1, ten_thousands, 0);
+            quad_led_put(2, digits[0], 0);
+        }
+        else if (val < 0)
+        {
+            quad_led_put(0, CHAR_DASH, 0);
+            quad_led_put(1, digits[0], 1);
+            quad_led_put(2, digits[1], 0);
+        }
+        else
+        {
+            quad_led_put(0, ten_thousands, 0);
+            quad_led_put(1, digits[0], 1);
+            quad_led_put(2, digits[1], 0);
+        }
+        quad_led_put(3, CHAR_K, 0);
+    }
+    frame_contents = FRAME_SIGNED;
+    frame_value = (unsigned int) val;
+}
+
+//******************************************************************************
+//Module Function quad_led_field_number()
+//Draws a signed number right aligned in a field, with a '-' in front of
+//negative numbers and the decimal point field->decimals digits from the right
+//The digits up to the decimal point are always drawn, so 5 with 1 decimal is
+//0.5. More decimals than LED_DIGITS - 1 are taken as LED_DIGITS - 1. A number
+//that does not fit fills the field with '-'
+//*******************************************************************************
+static void quad_led_field_number(led_glyph_t *frame, const led_field_t *field,
+                                  int val)
+{
+    unsigned int mag = (val < 0) ? 0u - (unsigned int) val : (unsigned int) val;
+    unsigned char digits[LED_DIGITS];
+    // the 1s place is always drawn, so at most LED_DIGITS - 1 decimals
+    int decimals = (field->decimals < LED_DIGITS) ? field->decimals
+                                                  : LED_DIGITS - 1;
+    int first = 0; // leftmost digit drawn
+    int pos = field->pos + field->width;
+    int i;
+    if (mag <= 9999)
+    {
+        quad_led_to_digits(mag, digits);
+        // skip leading zeros, but not the 1s place or the decimals
+        while (first < LED_DIGITS - 1 - decimals && digits[first] == 0)
+        {
+            first++;
+        }
+    }
+    if (mag > 9999 || LED_DIGITS - first + (val < 0) > field->width)
+    {
+        for (i = field->pos; i < field->pos + field->width; i++)
+        {
+            frame[i] = led_glyphs[CHAR_DASH];
+        }
+        return;
+    }
+    // rightmost digit first
+    for (i = LED_DIGITS; i > first; i--)
+    {
+        frame[--pos] = quad_led_glyph(digits[i - 1], decimals != 0
+                && i == LED_DIGITS - decimals);
+    }
+    if (val < 0)
+    {
+        frame[--pos] = led_glyphs[CHAR_DASH];
+    }
+    while (pos > field->pos)
+    {
+        frame[--pos] = led_glyphs[CHAR_BLANK];
+    }
+}
+
+//******************************************************************************
+//Module Function quad_led_show_fields()
+//Builds a whole frame from a layout of count fields, values[i] being the value
+//of fields[i], and puts it in the framebuffer. Digits not in any field are
+//blank. Does nothing if the display already shows the same layout and values
+//*******************************************************************************
+void quad_led_show_fields(const led_field_t *fields, const int *values,
+                          unsigned int count)
+{
+    led_glyph_t frame[LED_DIGITS];
+    unsigned int i;
+    sequence_left = 0;
+    if (count > LED_DIGITS)
+    {
+        count = LED_DIGITS; // every field is at least one digit wide
+    }
+    if (frame_contents == FRAME_FIELDS && frame_fields == fields)
+    {
+        for (i = 0; i < count && frame_field_values[i] == values[i]; i++)
+            ;
+        if (i == count)
+        {
+            return;
+        }
+    }
+    for (i = 0; i < LED_DIGITS; i++)
+    {
+        frame[i] = led_glyphs[CHAR_BLANK];
+    }
+    for (i = 0; i < count; i++)
+    {
+        switch (fields[i].kind)
+        {
+        case FIELD_CHAR:
+            frame[fields[i].pos] = quad_led_glyph(values[i], 0);
+            break;
+        case FIELD_NUMBER:
+            quad_led_field_number(frame, &fields[i], values[i]);
+            break;
+        default:
+            break;
+        }
+        frame_field_values[i] = values[i];
+    }
+    for (i = 0; i < LED_DIGITS; i++)
+    {
+        led_frame[i].word = frame[i].word;
+    }
+    frame_contents = FRAME_FIELDS;
+    frame_fields = fields;
+}
+
+//******************************************************************************
+//Module Function quad_led_play_numbers()
+//Shows count numbers one after the other, each one for frames display frames,
+//and returns at once. The numbers are changed by the refresh interrupt, the
+//last one stays on the display. Showing anything else stops the sequence
+//The numbers must stay valid until the sequence is done
+//*******************************************************************************
+void quad_led_play_numbers(const unsigned int *numbers, unsigned int count,
+                           unsigned int frames)
+{
+    unsigned char digits[LED_DIGITS];
+    sequence_left = 0;
+    frame_contents = FRAME_CHARS;
+    if (count == 0 || frames == 0)
+    {
+        return;
+    }
+    quad_led_to_digits((numbers[0] <= 9999) ? numbers[0] : 9999, digits);
+    quad_led_draw_digits(digits, QUAD_LED_NO_DP);
+    sequence_numbers = numbers;
+    sequence_frames_each = frames;
+    sequence_frames = frames;
+    sequence_left = count;
+}
+
+//******************************************************************************
+//Module Function quad_led_set_brightness()
+//Sets how long each digit is lit, from 0 (1/8 of the time) to
+//QUAD_LED_BRIGHTNESS_MAX (all the time). Takes effect from the next digit
+//*******************************************************************************
+void quad_led_set_brightness(unsigned int level)
+{
+    brightness = (level < QUAD_LED_BRIGHTNESS_LEVELS) ?
+            level : QUAD_LED_BRIGHTNESS_MAX;
+}
+
+//******************************************************************************
+//Module Function quad_led_wait_frames()
+//Sleeps in LPM0 until the given number of frames has been shown
+//*******************************************************************************
+void quad_led_wait_frames(unsigned int frames)
+{
+    __disable_interrupt();
+    frames_left = frames;
+    while (frames_left)
+    {
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+//******************************************************************************
+//interrupt quad_led_refresh_interrupt()
+//Lights the next digit of the framebuffer on every timer interrupt, so the
+//display is refreshed at a fixed rate whatever the main loop is doing
+//Below full brightness every digit takes two interrupts, one that lights it
+//and one that turns it off for the rest of its time
+//*******************************************************************************
+#pragma vector = REFRESH_VECTOR
+__interrupt void quad_led_refresh_interrupt(void)
+{
+    const unsigned int on_cycles = digit_on_cycles[brightness];
+    led_glyph_t glyph;
+    if (digit_lit && on_cycles < LED_DIGIT_CYCLES)
+    {
+        // off phase of the digit that was just lit
+        P2OUT &= ~ALL_DIGITS;
+        REFRESH_TCCR0 = LED_DIGIT_CYCLES - on_cycles - 1;
+        digit_lit = 0;
+        return;
+    }
+    glyph.word = led_frame[current_digit].word;
+    // turn the digits off before changing segments, so the new segments do
+    // not show on the previous digit
+    P2OUT &= ~ALL_DIGITS;
+    P1OUT = (P1OUT | P1_SEGMENTS) & ~glyph.ports.p1;
+    P2OUT = ((P2OUT | P2_SEGMENTS) & ~glyph.ports.p2) | led_digit_pins[current_digit];
+    REFRESH_TCCR0 = on_cycles - 1;
+    digit_lit = 1;
+    if (++current_digit == LED_DIGITS)
+    {
+        current_digit = 0;
+        // a whole frame has been shown, wake up quad_led_wait_frames if done
+        if (frames_left && --frames_left == 0)
+        {
+            __bic_SR_register_on_exit(LPM0_bits);
+        }
+        // move a sequence being played on to its next number
+        if (sequence_left && --sequence_frames == 0 && --sequence_left != 0)
+        {
+            unsigned char digits[LED_DIGITS];
+            const unsigned int val = *++sequence_numbers;
+            quad_led_to_digits((val <= 9999) ? val : 9999, digits);
+            quad_led_draw_digits(digits, QUAD_LED_NO_DP);
+            sequence_frames = sequence_frames_each;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ *  quad_led.h
+ *  Multiplexed quad digit 7-segment LED display shared by the projects
+ *  The display is refreshed from a Timer_A interrupt out of a 4 digit
+ *  framebuffer, the application only writes characters into the framebuffer
+ *  Each project describes its wiring in its own led_pins.h
+ */
+
+#ifndef QUAD_LED_H_
+#define QUAD_LED_H_
+
+#define LED_DIGITS 4
+
+// brightness levels of quad_led_set_brightness(), each one lights the digits
+// twice as long as the one below it
+#define QUAD_LED_BRIGHTNESS_LEVELS 4
+#define QUAD_LED_BRIGHTNESS_MAX (QUAD_LED_BRIGHTNESS_LEVELS - 1)
+
+// dp_pos of quad_led_show_number_dp() with no decimal point lit
+#define QUAD_LED_NO_DP LED_DIGITS
+
+// bytes of static RAM the driver takes on the MSP430: the framebuffer, the
+// cached digits and field values, and 23 bytes of counters and state. For RAM
+// budget checks at build time
+#define QUAD_LED_RAM (5 * LED_DIGITS + 23)
+
+//enum for numbers/characters on LED
+typedef enum
+{
+    NUM_0,
+    NUM_1,
+    NUM_2,
+    NUM_3,
+    NUM_4,
+    NUM_5,
+    NUM_6,
+    NUM_7,
+    NUM_8,
+    NUM_9,
+    CHAR_X,
+    CHAR_Y,
+    CHAR_Z,
+    CHAR_K,
+    CHAR_DASH,
+    CHAR_BLANK
+} LED_CHARS;
+
+// kinds of field a display layout is made of
+typedef enum
+{
+    FIELD_CHAR, // one character, the value is a LED_CHARS
+    FIELD_NUMBER // signed number, right aligned
+} LED_FIELD_KIND;
+
+// one field of a display layout, layouts are meant to be const tables
+typedef struct
+{
+    LED_FIELD_KIND kind;
+    unsigned char pos; // leftmost digit of the field, 0 is the leftmost digit
+    unsigned char width; // digits in the field, 1 for FIELD_CHAR
+    unsigned char decimals; // FIELD_NUMBER digits after the decimal point, up to
+                            // LED_DIGITS - 1
+} led_field_t;
+
+//******************************************************************************
+//Module Function quad_led_init()
+//Sets the digit and segment pins in led_pins.h as outputs, clears the display
+//and starts the timer that refreshes it. Interrupts need to be enabled
+//*******************************************************************************
+void quad_led_init(void);
+
+//******************************************************************************
+//Module Function quad_led_clear()
+//Blanks all digits of the framebuffer
+//*******************************************************************************
+void quad_led_clear(void);
+
+//******************************************************************************
+//Module Function quad_led_set_char()
+//Puts a character in the framebuffer, pos 0 is the leftmost digit
+//*******************************************************************************
+void quad_led_set_char(unsigned int pos, LED_CHARS led_char);
+
+//******************************************************************************
+//Module Function quad_led_set_char_dp()
+//Puts a character with its decimal point lit in the framebuffer
+//*******************************************************************************
+void quad_led_set_char_dp(unsigned int pos, LED_CHARS led_char);
+
+//******************************************************************************
+//Module Function quad_led_set_dp()
+//Lights the decimal point of a digit of the framebuffer, until the character of
+//that digit is set again. Does nothing if led_pins.h has no decimal point
+//*******************************************************************************
+void quad_led_set_dp(unsigned int pos);
+
+//******************************************************************************
+//Module Function quad_led_show_number()
+//Puts a number in the framebuffer, right aligned, with the unused digits blank
+//Numbers above 9999 blank the whole display. Does nothing if the display
+//already shows the number, and the digits are only worked out again when the
+//number differs from the last one shown
+//*******************************************************************************
+void quad_led_show_number(unsigned int val);
+
+//******************************************************************************
+//Module Function quad_led_show_number_dp()
+//Same as quad_led_show_number(), with the decimal point of digit dp_pos lit
+//Every digit is written once with its decimal point already in it
+//*******************************************************************************
+void quad_led_show_number_dp(unsigned int val, unsigned int dp_pos);
+
+//******************************************************************************
+//Module Function quad_led_show_signed()
+//Puts a signed number in the framebuffer, right aligned with a '-' in front of
+//negative numbers. -999 to 9999 are shown as they are, anything bigger in
+//thousands with a k on the last digit, e.g. 12.3k, -4.5k or -32k
+//Does nothing if the display already shows the number
+//*******************************************************************************
+void quad_led_show_signed(int val);
+
+//******************************************************************************
+//Module Function quad_led_show_fields()
+//Builds a whole frame from a layout of count fields, values[i] being the value
+//of fields[i], and puts it in the framebuffer. Digits not in any field are
+//blank. Does nothing if the display already shows the same layout and values
+//*******************************************************************************
+void quad_led_show_fields(const led_field_t *fields, const int *values,
+                          unsigned int count);
+
+//******************************************************************************
+//Module Function quad_led_play_numbers()
+//Shows count numbers one after the other, each one for frames display frames,
+//and returns at once. The numbers are changed by the refresh interrupt, the
+//last one stays on the display. Showing anything else stops the sequence
+//The numbers must stay valid until the sequence is done
+//*******************************************************************************
+void quad_led_play_numbers(const unsigned int *numbers, unsigned int count,
+                           unsigned int frames);
+
+//******************************************************************************
+//Module Function quad_led_set_brightness()
+//Sets how long each digit is lit, from 0 (1/8 of the time) to
+//QUAD_LED_BRIGHTNESS_MAX (all the time). Takes effect from the next digit
+//*******************************************************************************
+void quad_led_set_brightness(unsigned int level);
+
+//******************************************************************************
+//Module Function quad_led_wait_frames()
+//Sleeps in LPM0 until the given number of frames has been shown
+//*******************************************************************************
+void quad_led_wait_frames(unsigned int frames);
+
+#endif /* QUAD_LED_H_ */
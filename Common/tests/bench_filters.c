@@ -0,0 +1,188 @@
+/*
+ *  bench_filters.c
+ *  Host timing of each filter stage in filters.c and of the code it replaced,
+ *  on the pot-like input of the median table in the README: 500 + 0..8 counts
+ *  with a 1/50 random spike. Gives ns per sample on the host, which only
+ *  compares the stages with each other, not MSP430 cycles
+ *  make -C Common/tests bench runs it
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+#include "filters.h"
+
+#define SAMPLES 100000UL
+#define RUNS 20 // the fastest run is kept, the others saw more interruptions
+#define OLD_WEIGHT 10 // weight of the old running average
+
+static unsigned int input[SAMPLES];
+static volatile unsigned int sink; // keeps the outputs from being optimized out
+static unsigned long random_state = 1;
+
+// 16 bit pseudo random numbers, the same sequence on every run
+static unsigned int random_16(void)
+{
+    random_state = random_state * 1103515245UL + 12345UL;
+    return (unsigned int) ((random_state >> 8) & 0xFFFFUL);
+}
+
+// stages timed, the new one and the code it replaced where there was any
+typedef enum
+{
+    BENCH_MEDIAN,
+    BENCH_SPIKE,
+    BENCH_EMA,
+    BENCH_DEADBAND,
+    BENCH_CIC,
+    BENCH_TRACK,
+    BENCH_STATS,
+    BENCH_OLD_SORT,
+    BENCH_OLD_AVERAGE
+} BENCH_KIND;
+
+// median of the last size samples by sorting a copy of them, as the old
+// read_adc_median_filtered() did for every output
+static unsigned int old_sort_median(unsigned int *window, unsigned int size,
+                                    unsigned int sample)
+{
+    unsigned int sorted[MEDIAN_WINDOW_MAX];
+    unsigned int i, j, tmp;
+    for (i = size - 1; i > 0; i--)
+    {
+        window[i] = window[i - 1];
+    }
+    window[0] = sample;
+    for (i = 0; i < size; i++)
+    {
+        sorted[i] = window[i];
+    }
+    for (i = 1; i < size; i++)
+    {
+        for (j = 0; j < size - i; j++)
+        {
+            if (sorted[j] > sorted[j + 1])
+            {
+                tmp = sorted[j];
+                sorted[j] = sorted[j + 1];
+                sorted[j + 1] = tmp;
+            }
+        }
+    }
+    return sorted[size / 2];
+}
+
+// one pass of a stage over the whole input, in ns per sample
+static double bench_run(BENCH_KIND kind, unsigned int size)
+{
+    static unsigned int ring[MEDIAN_WINDOW_MAX], sorted[MEDIAN_WINDOW_MAX];
+    static unsigned int window[MEDIAN_WINDOW_MAX];
+    median_filter_t median;
+    spike_filter_t spike;
+    ema_filter_t ema;
+    deadband_filter_t deadband;
+    cic_filter_t cic;
+    track_filter_t track;
+    channel_stats_t stats;
+    unsigned int average = input[0];
+    unsigned int output = 0;
+    struct timespec start, end;
+    unsigned long n;
+
+    median_filter_init(&median, ring, sorted, size);
+    spike_filter_init(&spike, size);
+    ema_filter_init(&ema, size);
+    deadband_filter_init(&deadband, size);
+    cic_filter_init(&cic, size, 2);
+    track_filter_init(&track, 1, 3, 20);
+    channel_stats_reset(&stats);
+    for (n = 0; n < size; n++)
+    {
+        window[n] = input[0];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < SAMPLES; n++)
+    {
+        switch (kind)
+        {
+        case BENCH_MEDIAN:
+            output += median_filter_update(&median, input[n]);
+            break;
+        case BENCH_SPIKE:
+            output += spike_filter_update(&spike, input[n]);
+            break;
+        case BENCH_EMA:
+            output += ema_filter_update(&ema, input[n]);
+            break;
+        case BENCH_DEADBAND:
+            output += deadband_filter_update(&deadband, input[n]);
+            break;
+        case BENCH_CIC:
+            cic_filter_update(&cic, input[n], &output);
+            break;
+        case BENCH_TRACK:
+            output += track_filter_update(&track, input[n]);
+            break;
+        case BENCH_STATS:
+            if (stats.count == STATS_COUNT_MAX)
+            {
+                output += channel_stats_mean(&stats);
+                channel_stats_reset(&stats);
+            }
+            channel_stats_update(&stats, input[n]);
+            break;
+        case BENCH_OLD_SORT:
+            output += old_sort_median(window, size, input[n]);
+            break;
+        case BENCH_OLD_AVERAGE:
+            average = (average * OLD_WEIGHT + input[n]) / (OLD_WEIGHT + 1);
+            output += average;
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    sink = output;
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec))
+            / SAMPLES;
+}
+
+// fastest of RUNS passes, printed as a table row
+static void bench(const char *stage, BENCH_KIND kind, unsigned int size)
+{
+    double best = 0, ns;
+    unsigned int run;
+    for (run = 0; run < RUNS; run++)
+    {
+        ns = bench_run(kind, size);
+        best = (run == 0 || ns < best) ? ns : best;
+    }
+    printf("| %-28s | %7.1f |\n", stage, best);
+}
+
+int main(void)
+{
+    unsigned long n;
+    for (n = 0; n < SAMPLES; n++)
+    {
+        input[n] = (random_16() % 50 == 0) ? random_16() % 1024
+                                           : 500 + random_16() % 9;
+    }
+    printf("| %-28s | %7s |\n", "Stage", "ns");
+    bench("median of 11", BENCH_MEDIAN, 11);
+    bench("median of 31", BENCH_MEDIAN, 31);
+    bench("old sort of 11", BENCH_OLD_SORT, 11);
+    bench("old sort of 31", BENCH_OLD_SORT, 31);
+    bench("spike 3", BENCH_SPIKE, 3);
+    bench("spike 5", BENCH_SPIKE, 5);
+    bench("old sort of 5", BENCH_OLD_SORT, 5);
+    bench("EMA shift 2", BENCH_EMA, 2);
+    bench("EMA shift 8", BENCH_EMA, 8);
+    bench("old running average", BENCH_OLD_AVERAGE, 0);
+    bench("deadband 6", BENCH_DEADBAND, 6);
+    bench("CIC order 1, ratio 4", BENCH_CIC, 1);
+    bench("CIC order 2, ratio 4", BENCH_CIC, 2);
+    bench("tracker", BENCH_TRACK, 0);
+    bench("statistics", BENCH_STATS, 0);
+    return 0;
+}
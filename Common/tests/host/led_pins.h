@@ -0,0 +1,35 @@
+/*
+ *  led_pins.h
+ *  Pin map of the quad digit LED for the host tests, every segment and the
+ *  decimal point on a pin of its own
+ */
+
+#ifndef LED_PINS_H_
+#define LED_PINS_H_
+
+#define LED_DIGIT_1 BIT3
+#define LED_DIGIT_2 BIT2
+#define LED_DIGIT_3 BIT1
+#define LED_DIGIT_4 BIT0
+
+#define LED_SEG_A_PORT 1
+#define LED_SEG_A_PIN BIT0
+#define LED_SEG_B_PORT 1
+#define LED_SEG_B_PIN BIT1
+#define LED_SEG_C_PORT 1
+#define LED_SEG_C_PIN BIT2
+#define LED_SEG_D_PORT 1
+#define LED_SEG_D_PIN BIT3
+#define LED_SEG_E_PORT 1
+#define LED_SEG_E_PIN BIT4
+#define LED_SEG_F_PORT 1
+#define LED_SEG_F_PIN BIT5
+#define LED_SEG_G_PORT 1
+#define LED_SEG_G_PIN BIT6
+#define LED_SEG_DP_PORT 2
+#define LED_SEG_DP_PIN BIT4
+
+#define LED_DIGIT_CYCLES 3000
+#define LED_REFRESH_TIMER 0
+
+#endif /* LED_PINS_H_ */
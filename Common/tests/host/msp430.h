@@ -0,0 +1,36 @@
+/*
+ *  msp430.h
+ *  Host stand-in for the MSP430 header, for the tests only. The registers are
+ *  plain variables and the intrinsics do nothing
+ */
+
+#ifndef HOST_MSP430_H_
+#define HOST_MSP430_H_
+
+static volatile unsigned char P1DIR, P1OUT, P2DIR, P2OUT, P2SEL, P2SEL2;
+static volatile unsigned int TA0CTL, TA0CCR0, TA0CCTL0;
+static volatile unsigned int TA1CTL, TA1CCR0, TA1CCTL0;
+
+#define BIT0 0x01
+#define BIT1 0x02
+#define BIT2 0x04
+#define BIT3 0x08
+#define BIT4 0x10
+#define BIT5 0x20
+#define BIT6 0x40
+#define BIT7 0x80
+
+#define TASSEL_2 0x0200
+#define MC_1 0x0010
+#define TACLR 0x0004
+#define CCIE 0x0010
+#define GIE 0x0008
+#define LPM0_bits 0x0010
+
+#define __interrupt
+#define __disable_interrupt() ((void) 0)
+#define __enable_interrupt() ((void) 0)
+#define __bis_SR_register(bits) ((void) (bits))
+#define __bic_SR_register_on_exit(bits) ((void) (bits))
+
+#endif /* HOST_MSP430_H_ */
@@ -0,0 +1,453 @@
+/*
+ *  test_filters.c
+ *  Host tests of the filters in filters.c
+ *  The median networks against a reference sort: every combination of the
+ *  inputs 0 to 5, random 16 bit inputs and long spike_filter_t streams, all
+ *  compared with the middle of a qsort. The EMA, the CIC decimator, the tracker
+ *  and the statistics against the same filters worked out in floating point
+ *  or wider integers
+ *  Built with the host compiler, see the Makefile next to it
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "filters.h"
+
+#define SMALL_VALUES 6 // inputs 0 to 5, so every order and tie is covered
+#define RANDOM_ROUNDS 1000000UL
+#define STREAM_LENGTH 200000UL
+#define CIC_TAPS_MAX (CIC_ORDER_MAX << 5) // order * 2^ratio_shift of the tests
+
+static unsigned long failures = 0;
+static unsigned long random_state = 1;
+
+// 16 bit pseudo random numbers, the same sequence on every run
+static unsigned int random_16(void)
+{
+    random_state = random_state * 1103515245UL + 12345UL;
+    return (unsigned int) ((random_state >> 8) & 0xFFFFUL);
+}
+
+static int compare_unsigned(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *) a;
+    unsigned int y = *(const unsigned int *) b;
+    return (x > y) - (x < y);
+}
+
+// middle value of count values, by sorting a copy
+static unsigned int reference_median(const unsigned int *values,
+                                     unsigned int count)
+{
+    unsigned int sorted[5];
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        sorted[i] = values[i];
+    }
+    qsort(sorted, count, sizeof(sorted[0]), compare_unsigned);
+    return sorted[count / 2];
+}
+
+// counts a failure and prints the first few
+static void fail(const char *what, long input, long got, long expected)
+{
+    if (failures < 10)
+    {
+        printf("FAIL %s at %ld: %ld, expected %ld\n", what, input, got,
+               expected);
+    }
+    failures++;
+}
+
+static void check(const char *what, const unsigned int *values,
+                  unsigned int count, unsigned int got)
+{
+    unsigned int expected = reference_median(values, count);
+    unsigned int i;
+    if (got != expected)
+    {
+        if (failures < 10)
+        {
+            printf("FAIL %s(", what);
+            for (i = 0; i < count; i++)
+            {
+                printf(i ? ", %u" : "%u", values[i]);
+            }
+            printf(") = %u, expected %u\n", got, expected);
+        }
+        failures++;
+    }
+}
+
+static void check_median_of_3(const unsigned int *v)
+{
+    check("median_of_3", v, 3, median_of_3(v[0], v[1], v[2]));
+}
+
+static void check_median_of_5(const unsigned int *v)
+{
+    check("median_of_5", v, 5, median_of_5(v[0], v[1], v[2], v[3], v[4]));
+}
+
+static void test_small_inputs(void)
+{
+    unsigned int v[5];
+    unsigned int combination, i, rest;
+
+    for (combination = 0; combination < SMALL_VALUES * SMALL_VALUES
+            * SMALL_VALUES; combination++)
+    {
+        for (i = 0, rest = combination; i < 3; i++, rest /= SMALL_VALUES)
+        {
+            v[i] = rest % SMALL_VALUES;
+        }
+        check_median_of_3(v);
+    }
+    for (combination = 0; combination < SMALL_VALUES * SMALL_VALUES
+            * SMALL_VALUES * SMALL_VALUES * SMALL_VALUES; combination++)
+    {
+        for (i = 0, rest = combination; i < 5; i++, rest /= SMALL_VALUES)
+        {
+            v[i] = rest % SMALL_VALUES;
+        }
+        check_median_of_5(v);
+    }
+}
+
+static void test_random_inputs(void)
+{
+    unsigned int v[5];
+    unsigned long round;
+    unsigned int i;
+
+    for (round = 0; round < RANDOM_ROUNDS; round++)
+    {
+        for (i = 0; i < 5; i++)
+        {
+            v[i] = random_16();
+        }
+        check_median_of_3(v);
+        check_median_of_5(v);
+    }
+}
+
+// a spike filter against the median of its own copy of the last size samples,
+// the first sample standing in for the ones before it
+static void test_spike_stream(unsigned int size)
+{
+    spike_filter_t filter;
+    unsigned int window[5];
+    unsigned long n;
+    unsigned int i, sample;
+
+    spike_filter_init(&filter, size);
+    for (n = 0; n < STREAM_LENGTH; n++)
+    {
+        // mostly a slow walk with spikes, sometimes anything at all
+        sample = (n % 7 == 3 || n % 11 == 0) ? random_16()
+                                             : (unsigned int) (n / 64) & 0xFFFF;
+        if (n == 0)
+        {
+            for (i = 0; i < size; i++)
+            {
+                window[i] = sample;
+            }
+        }
+        for (i = size - 1; i > 0; i--)
+        {
+            window[i] = window[i - 1];
+        }
+        window[0] = sample;
+        check(size == 3 ? "spike_filter_update 3" : "spike_filter_update 5",
+              window, size, spike_filter_update(&filter, sample));
+    }
+}
+
+// a steady input after a step is taken exactly, whatever the shift, and a
+// random walk stays within 1 of the average worked out in floating point
+static void test_ema(void)
+{
+    static const unsigned int steady[] = { 0, 1, 1000, 4095, 65535 };
+    ema_filter_t filter;
+    unsigned int shift, i, output = 0;
+    unsigned long n;
+    double reference, weight;
+    unsigned int sample;
+
+    for (shift = 0; shift <= EMA_SHIFT_MAX; shift++)
+    {
+        for (i = 0; i < sizeof(steady) / sizeof(steady[0]); i++)
+        {
+            ema_filter_init(&filter, shift);
+            ema_filter_update(&filter, steady[i] ? 0 : 65535);
+            // 2^shift samples take the step to 1/e of the way, 32 times that
+            // leaves a small fraction of a count
+            for (n = 0; n < (32UL << shift); n++)
+            {
+                output = ema_filter_update(&filter, steady[i]);
+            }
+            if (output != steady[i])
+            {
+                fail("ema_filter_update steady", shift, output, steady[i]);
+            }
+        }
+    }
+    for (shift = 0; shift <= 8; shift++)
+    {
+        weight = 1.0 / (1UL << shift);
+        sample = 2000;
+        ema_filter_init(&filter, shift);
+        reference = sample;
+        ema_filter_update(&filter, sample);
+        for (n = 0; n < STREAM_LENGTH; n++)
+        {
+            sample = (sample + random_16() % 65 - 32) & 0x0FFF;
+            output = ema_filter_update(&filter, sample);
+            reference += (sample - reference) * weight;
+            if (output > reference + 1.0 || output < reference - 1.0)
+            {
+                fail("ema_filter_update walk", shift, output,
+                     (long) (reference + 0.5));
+                break;
+            }
+        }
+    }
+}
+
+// every output of a CIC decimator against the direct sum of the samples it
+// covers, weighted by order boxcars of 2^ratio_shift convolved together
+static void test_cic(void)
+{
+    static unsigned int history[CIC_TAPS_MAX]; // newest first
+    unsigned long weights[CIC_TAPS_MAX];
+    unsigned long next[CIC_TAPS_MAX];
+    cic_filter_t filter;
+    unsigned int order, ratio_shift, stage, taps, ratio, k, j;
+    unsigned int output, expected, outputs;
+    unsigned long n, sum;
+
+    for (order = 1; order <= CIC_ORDER_MAX; order++)
+    {
+        for (ratio_shift = 0; ratio_shift <= 5; ratio_shift++)
+        {
+            ratio = 1U << ratio_shift;
+            // weights of order boxcars of ratio samples, taps of them
+            taps = 1;
+            weights[0] = 1;
+            for (stage = 0; stage < order; stage++)
+            {
+                for (k = 0; k < taps + ratio - 1; k++)
+                {
+                    next[k] = 0;
+                    for (j = 0; j < ratio; j++)
+                    {
+                        if (k >= j && k - j < taps)
+                        {
+                            next[k] += weights[k - j];
+                        }
+                    }
+                }
+                taps += ratio - 1;
+                for (k = 0; k < taps; k++)
+                {
+                    weights[k] = next[k];
+                }
+            }
+            cic_filter_init(&filter, order, ratio_shift);
+            outputs = 0;
+            for (n = 0; n < STREAM_LENGTH / 4; n++)
+            {
+                for (k = CIC_TAPS_MAX - 1; k > 0; k--)
+                {
+                    history[k] = history[k - 1];
+                }
+                history[0] = random_16();
+                if (!cic_filter_update(&filter, history[0], &output))
+                {
+                    continue;
+                }
+                outputs++;
+                if (n + 1 < (unsigned long) order * ratio || (n + 1) % ratio)
+                {
+                    fail("cic_filter_update early output", n, output, 0);
+                    continue;
+                }
+                sum = 0;
+                for (k = 0; k < taps; k++)
+                {
+                    sum += weights[k] * history[k];
+                }
+                // the gain is ratio^order, rounded off
+                expected = (unsigned int) ((sum + ((1UL << (order * ratio_shift))
+                        >> 1)) >> (order * ratio_shift));
+                if (output != expected)
+                {
+                    fail(order == 1 ? "cic_filter_update order 1"
+                                    : "cic_filter_update", n, output, expected);
+                }
+            }
+            if (outputs != (STREAM_LENGTH / 4) / ratio - (order - 1))
+            {
+                fail("cic_filter_update outputs", order, outputs,
+                     (long) ((STREAM_LENGTH / 4) / ratio - (order - 1)));
+            }
+        }
+    }
+}
+
+// a constant, a ramp, single outliers and a real jump
+static void test_track(void)
+{
+    track_filter_t filter;
+    int output = 0;
+    long n;
+
+    track_filter_init(&filter, 1, 3, 0);
+    for (n = 0; n < 100; n++)
+    {
+        output = track_filter_update(&filter, 1234);
+        if (output != 1234 || track_filter_rate(&filter) != 0)
+        {
+            fail("track_filter_update constant", n, output, 1234);
+        }
+    }
+    // negative samples, like a bad echo, are taken the same way
+    track_filter_init(&filter, 1, 3, 0);
+    for (n = 0; n < 100; n++)
+    {
+        output = track_filter_update(&filter, -1234);
+        if (output != -1234 || track_filter_rate(&filter) != 0)
+        {
+            fail("track_filter_update negative", n, output, -1234);
+        }
+    }
+    // 3 counts an update, after settling the estimate is on the ramp and the
+    // rate is 3 counts, less what the shifts of the corrections round off
+    track_filter_init(&filter, 1, 3, 20);
+    for (n = 0; n < 200; n++)
+    {
+        output = track_filter_update(&filter, (int) (100 + 3 * n));
+    }
+    if (output != 100 + 3 * (n - 1))
+    {
+        fail("track_filter_update ramp", n, output, 100 + 3 * (n - 1));
+    }
+    if (abs(track_filter_rate(&filter) - 3 * TRACK_RATE_SCALE)
+            > TRACK_RATE_SCALE / 8)
+    {
+        fail("track_filter_rate ramp", n, track_filter_rate(&filter),
+             3 * TRACK_RATE_SCALE);
+    }
+    // every 10th sample far off, the estimate stays where it was
+    track_filter_init(&filter, 1, 3, 20);
+    for (n = 0; n < 1000; n++)
+    {
+        output = track_filter_update(&filter, (n % 10 == 5) ? 500 : 100);
+        if (output != 100)
+        {
+            fail("track_filter_update outlier", n, output, 100);
+        }
+    }
+    // TRACK_MISSES_MAX samples in a row at the new value start it over there
+    for (n = 1; n <= TRACK_MISSES_MAX; n++)
+    {
+        output = track_filter_update(&filter, 500);
+        if (output != (n < TRACK_MISSES_MAX ? 100 : 500))
+        {
+            fail("track_filter_update jump", n, output,
+                 n < TRACK_MISSES_MAX ? 100 : 500);
+        }
+    }
+    if (track_filter_rate(&filter) != 0)
+    {
+        fail("track_filter_rate jump", n, track_filter_rate(&filter), 0);
+    }
+}
+
+// windows of random samples against the same sums worked out in 64 bits
+static void test_stats(void)
+{
+    channel_stats_t stats;
+    unsigned int count, i, sample, base, spread;
+    unsigned int min, max;
+    long long sum, sum_squares, n;
+    unsigned long round;
+
+    for (round = 0; round < 20000; round++)
+    {
+        count = 1 + random_16() % STATS_COUNT_MAX;
+        base = random_16();
+        spread = 1 + random_16() % 4096;
+        if (base > 65535 - 4095)
+        {
+            base = 65535 - 4095;
+        }
+        channel_stats_reset(&stats);
+        min = 65535;
+        max = 0;
+        sum = 0;
+        sum_squares = 0;
+        for (i = 0; i < count; i++)
+        {
+            sample = base + random_16() % spread;
+            channel_stats_update(&stats, sample);
+            min = (sample < min) ? sample : min;
+            max = (sample > max) ? sample : max;
+            sum += sample;
+            sum_squares += (long long) sample * sample;
+        }
+        // more samples than the window holds are left out
+        channel_stats_update(&stats, base);
+        n = (count < STATS_COUNT_MAX) ? count + 1 : count;
+        if (count < STATS_COUNT_MAX)
+        {
+            min = (base < min) ? base : min;
+            sum += base;
+            sum_squares += (long long) base * base;
+        }
+        if (stats.count != n || stats.min != min || stats.max != max)
+        {
+            fail("channel_stats_update count, min, max", round, stats.count,
+                 (long) n);
+        }
+        // mean rounded to the nearest, either way on a tie, variance rounded
+        // down
+        if (llabs(2 * n * channel_stats_mean(&stats) - 2 * sum) > n)
+        {
+            fail("channel_stats_mean", round, channel_stats_mean(&stats),
+                 (long) ((2 * sum + n) / (2 * n)));
+        }
+        if (channel_stats_variance(&stats) != (unsigned long) ((n * sum_squares
+                - sum * sum) / (n * n)))
+        {
+            fail("channel_stats_variance", round, channel_stats_variance(&stats),
+                 (long) ((n * sum_squares - sum * sum) / (n * n)));
+        }
+    }
+}
+
+int main(void)
+{
+    test_small_inputs();
+    test_random_inputs();
+    test_spike_stream(3);
+    test_spike_stream(5);
+    if (failures)
+    {
+        printf("%lu failures\n", failures);
+        return 1;
+    }
+    printf("median networks match the reference sort\n");
+    test_ema();
+    test_cic();
+    test_track();
+    test_stats();
+    if (failures)
+    {
+        printf("%lu failures\n", failures);
+        return 1;
+    }
+    printf("EMA, CIC, tracker and statistics match the references\n");
+    return 0;
+}
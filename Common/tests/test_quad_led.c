@@ -0,0 +1,76 @@
+/*
+ *  test_quad_led.c
+ *  Host test of the digit conversion in quad_led.c against division, for
+ *  every number 0 to 9999, with a count of the work each conversion takes
+ *  against the divide and modulo calls of the old display_digits()
+ *  quad_led.c is included so its static functions can be called, with the
+ *  host stand-ins for msp430.h and led_pins.h in host/
+ */
+
+#include <stdio.h>
+#include "quad_led.c"
+
+// quotient bits the software divide of a part without a divider works out one
+// shift and subtract step at a time
+#define DIVIDE_STEPS 16
+
+// divide and modulo calls the old display_digits() made for a number, one
+// modulo for the 1s place and a divide and a modulo for every other digit
+static unsigned int old_divide_calls(unsigned int val)
+{
+    if (val <= 9)
+    {
+        return 1;
+    }
+    if (val <= 99)
+    {
+        return 3;
+    }
+    if (val <= 999)
+    {
+        return 5;
+    }
+    return 7;
+}
+
+int main(void)
+{
+    unsigned char digits[LED_DIGITS];
+    unsigned long failures = 0;
+    unsigned long new_steps = 0, old_steps = 0;
+    unsigned int new_worst = 0, old_worst = 0;
+    unsigned int val, steps;
+
+    for (val = 0; val <= 9999; val++)
+    {
+        quad_led_to_digits(val, digits);
+        if (digits[0] != val / 1000 || digits[1] != val / 100 % 10
+                || digits[2] != val / 10 % 10 || digits[3] != val % 10)
+        {
+            if (failures < 10)
+            {
+                printf("FAIL quad_led_to_digits(%u) = %u%u%u%u\n", val,
+                       digits[0], digits[1], digits[2], digits[3]);
+            }
+            failures++;
+        }
+        // one subtract step per unit of each digit left of the 1s place
+        steps = digits[0] + digits[1] + digits[2];
+        new_steps += steps;
+        new_worst = (steps > new_worst) ? steps : new_worst;
+        steps = old_divide_calls(val) * DIVIDE_STEPS;
+        old_steps += steps;
+        old_worst = (steps > old_worst) ? steps : old_worst;
+    }
+    printf("subtract steps per conversion: average %.1f, worst %u\n",
+           new_steps / 10000.0, new_worst);
+    printf("old divide steps per conversion: average %.1f, worst %u\n",
+           old_steps / 10000.0, old_worst);
+    if (failures)
+    {
+        printf("%lu failures\n", failures);
+        return 1;
+    }
+    printf("quad_led_to_digits matches division for 0 to 9999\n");
+    return 0;
+}
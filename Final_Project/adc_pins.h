@@ -0,0 +1,29 @@
+/*
+ *  adc_pins.h
+ *  ADC10 channels sampled on the Final Project transmitter
+ *  Used by Common/adc_sampler.c
+ */
+
+#ifndef ADC_PINS_H_
+#define ADC_PINS_H_
+
+// channels A0 up to this one are converted in every sequence
+#define ADC_HIGHEST_CHANNEL 4
+// only the accelerometer channels from this one up are queued
+#define ADC_LOWEST_CHANNEL 3
+
+// pins of port 1 used as analog inputs, the accelerometer x and y outputs
+#define ADC_INPUTS (BIT3 | BIT4) // p1.3, p1.4
+
+// Timer_A starting the sequences, 0 for Timer0_A or 1 for Timer1_A
+#define ADC_TRIGGER_TIMER 1 // Timer0_A runs the speaker PWM
+// sequences per second, 100 to 2000
+#define ADC_SAMPLE_RATE 400
+// 4^1 sequences summed into each 11 bit sample, 100 samples a second
+#define ADC_OVERSAMPLE_BITS 1
+
+// clock the samples are timestamped with, Timer1_A counts SMCLK continuously
+// for the echo capture so this is in us and wraps around every 65 ms
+#define ADC_TIME TA1R
+
+#endif /* ADC_PINS_H_ */
@@ -0,0 +1,40 @@
+/*
+ *  led_pins.h
+ *  Pin map of the quad digit LED for the Final Project receiver
+ *  Used by Common/quad_led.c to generate the segment masks at compile time
+ */
+
+#ifndef LED_PINS_H_
+#define LED_PINS_H_
+
+// PORT2 pins for turning on LED digits
+#define LED_DIGIT_1 BIT3 // p2.3
+#define LED_DIGIT_2 BIT2 // p2.2
+#define LED_DIGIT_3 BIT1 // p2.1
+#define LED_DIGIT_4 BIT0 // p2.0
+
+// port (1 or 2) and pin of each of the 7 segments
+#define LED_SEG_A_PORT 2
+#define LED_SEG_A_PIN BIT4 // p2.4
+#define LED_SEG_B_PORT 1
+#define LED_SEG_B_PIN BIT5 // p1.5
+#define LED_SEG_C_PORT 1
+#define LED_SEG_C_PIN BIT0 // p1.0
+#define LED_SEG_D_PORT 1
+#define LED_SEG_D_PIN BIT3 // p1.3
+#define LED_SEG_E_PORT 1
+#define LED_SEG_E_PIN BIT7 // p1.7
+#define LED_SEG_F_PORT 1
+#define LED_SEG_F_PIN BIT6 // p1.6
+#define LED_SEG_G_PORT 1
+#define LED_SEG_G_PIN BIT4 // p1.4
+
+// no decimal point wired
+
+// Number of SMCLK cycles each digit is lit by the refresh interrupt
+#define LED_DIGIT_CYCLES 3000
+
+// Timer_A used for refreshing the display, 0 for Timer0_A or 1 for Timer1_A
+#define LED_REFRESH_TIMER 0 // Timer0_A only drives the speaker on the Tx chip
+
+#endif /* LED_PINS_H_ */
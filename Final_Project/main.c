@@ -12,6 +12,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include "../Common/quad_led.h"
+#include "../Common/adc_sampler.h"
+#include "../Common/filters.h"
+#include "../Common/cordic.h"
+#include "../Common/info_flash.h"
 // Input pin to check identify microcontroller (high if Tx and low if Rx)
 #define MC_IDENTIFICATION_PIN BIT5 // p2.5
 // Ultrasonic sensor pins
@@ -22,64 +27,110 @@
 // UART PINS
 #define TX_PIN BIT2 // p1.2
 #define RX_PIN BIT1 // p1.1
-// PORT2 pins for turning on LED digits
-#define DIGIT_1 BIT3 // p2.3
-#define DIGIT_2 BIT2 // p2.2
-#define DIGIT_3 BIT1 // p2.1
-#define DIGIT_4 BIT0 // p2.0
-// 7 segments B-F of LED connected to pins of port1 and A to port2
-#define a BIT4        // p2.4
-#define b BIT5        // p1.5
-#define c BIT0        // p1.0
-#define d BIT3        // p1.3
-#define e BIT7        // p1.7
-#define f BIT6        // p1.6
-#define g BIT4        // p1.4
-#define DIGDELAY 3000 // Number of cycles to delay for displaying each digit in
-// display_digits
+// quad digit LED pins of the Rx chip are in led_pins.h
 #define DELAY_SEC 1000000 // 1 sec delay for 1MHz
 #define NUM_DISTANCE_PRESETS 5
-
-// ADC Input pins for accelerometer
-#define ACCL_INPUT_X BIT3 // p1.3
-#define ACCL_INPUT_Y BIT4 // p1.4
+#define PRESET_SHOW_FRAMES 80 // frames each preset is shown for at boot (~1 s)
+#define RX_FRAME_LENGTH 25    // bytes collected from UART before parsing
+#define IDLE_RX_FRAMES 30     // frames with an unchanged reading before dimming
+#define IDLE_BRIGHTNESS 0     // display brightness while the reading is steady
+
+// ADC channels of the accelerometer, the pins are in adc_pins.h
+#define ACCL_CHANNEL_X 3 // p1.3
+#define ACCL_CHANNEL_Y 4 // p1.4
+// index of each axis in the samples of the sampler and in level_values
+#define ACCL_X ADC_INDEX(ACCL_CHANNEL_X)
+#define ACCL_Y ADC_INDEX(ACCL_CHANNEL_Y)
+// accelerometer reading of both axes when the board is level and the change
+// for 1 g, about 0.33 V on the 3.3 V scale, 10 bit ADC counts times the
+// oversampling gain of the readings. The level reading is only used until the
+// board has been calibrated, see calibrate_level()
+#define LEVEL_ADC_VALUE (490 * ADC_GAIN)
+#define LEVEL_COUNTS_PER_G (100 * ADC_GAIN)
+// largest pitch and roll for the levelling alarm, in tenths of a degree. About
+// what the old check of 10 counts from level allowed
+#define LEVEL_MAX_TILT 57
+// the levelling alarm checks each axis through a tracker with gains of
+// 1/2^LEVEL_ALPHA_SHIFT and 1/2^LEVEL_BETA_SHIFT, dropping samples further
+// than LEVEL_GATE from where the axis is headed, like a knock on the board
+#define LEVEL_ALPHA_SHIFT 2
+#define LEVEL_BETA_SHIFT 5
+#define LEVEL_GATE (30 * ADC_GAIN)
+// distance readings are tracked the same way, a single bad echo further than
+// DISTANCE_GATE cm from the track does not reach the alarm
+#define DISTANCE_ALPHA_SHIFT 1
+#define DISTANCE_BETA_SHIFT 3
+#define DISTANCE_GATE 20
+// a target moving more than 1 cm a reading can pass the preset between two
+// readings, so the alarm takes the preset as reached within half of the
+// tracked move per reading, but never further than DISTANCE_MAX_LEAD cm from
+// it, or a fast target would set it off far from the preset
+#define DISTANCE_MAX_LEAD 2
+// noise summaries of the raw readings are sent once every LEVEL_STATS_WINDOW
+// accelerometer samples, 2.56 s, and every DISTANCE_STATS_WINDOW distances, 5 s
+#define LEVEL_STATS_WINDOW 256
+#define DISTANCE_STATS_WINDOW 16
+// the levelling records sent to the Rx chip are CIC decimated, one record for
+// every 2^LEVEL_RECORD_SHIFT samples, 25 a second at 100 samples a second,
+// which the 9600 baud link keeps up with
+#define LEVEL_RECORD_SHIFT 2
+#define LEVEL_RECORD_ORDER 2
+// holding PRESET_BUTTON for this many levelling records, 2 s, calibrates the
+// level readings once it is let go
+#define CALIBRATE_HOLD_RECORDS 50
 
 // buttons
 #define PRESET_BUTTON BIT3 // p2.3
 #define MODE_BUTTON BIT4   // p2.4
 
-typedef enum
-{
-    A_SEGMENT = 0,
-    B_SEGMENT,
-    C_SEGMENT,
-    D_SEGMENT,
-    E_SEGMENT,
-    F_SEGMENT,
-    G_SEGMENT,
-} LED_SEGMENTS;
+// RAM of the MSP430G2553 and what is kept of it for the stack: the deepest
+// call, serial_write() with its 50 byte buffer down into vsprintf(), with an
+// interrupt on top. Give the linker the same --stack_size so it fails when the
+// RAM is full
+#define RAM_SIZE 512
+#define STACK_BUDGET 160
 
 typedef enum
 {
     DISTANCE_MEASURING_MODE = 0, LEVELLING_MODE
 } modes_t;
 
+// filters of the Tx chip, only the ones of the current mode are in use, so
+// both modes share the RAM and the filters are set up again on a mode change
+typedef union
+{
+    struct
+    {
+        track_filter_t track;
+        channel_stats_t stats;
+    } distance;
+    struct
+    {
+        track_filter_t x_track, y_track;
+        channel_stats_t x_stats, y_stats;
+        cic_filter_t x_decimator, y_decimator;
+    } level;
+} mode_filters_t;
+
 // distance measuring mode initially
 volatile modes_t current_mode = DISTANCE_MEASURING_MODE;
 
-void led_display_num(const unsigned val);
-void lit_led_segment(LED_SEGMENTS segment);
-void display_digits(unsigned int val);
-void display_axis_info(unsigned int x_axis_val, unsigned int y_axis_val);
+void display_axis_info(int x_axis_val, int y_axis_val);
+void tilt_angles(int x, int y, int *pitch, int *roll);
+void load_level_values(void);
+void init_mode_filters(modes_t mode);
+void calibrate_level(void);
 void uart_init();
 void serial_write(const char *fmt, ...);
+void send_stats(char channel, channel_stats_t *stats);
 void serial_rx_interrupt(void);
+void parse_rx_frame(void);
 void timer_interrupt(void);
 void gpio_setup_tx(void);
 void gpio_setup_rx(void);
 void timer_setup(void);
 void generate_trigger_signal(void);
-void buzzer_distance_mode(const unsigned int cm);
+void buzzer_distance_mode(const unsigned int cm, unsigned int tolerance);
 void buzzer_levelling_mode(void);
 void execute_tx();
 void execute_rx();
@@ -88,24 +139,47 @@ void init_buttons(void);
 void update_distance_preset(void);
 void show_presets(unsigned int preset_distance);
 void configure_adc();
-void read_adc(unsigned int *x_axis, unsigned int *y_axis);
-unsigned int read_adc_running_average_filter(unsigned int raw_adc_val,
-                                             unsigned int oldaverage,
-                                             unsigned int weight);
+unsigned int read_adc(unsigned int *x_axis, unsigned int *y_axis);
 
 volatile int rising_edge_value, falling_edge_value;
 volatile int diff;
 volatile unsigned int i = 0;
 volatile int distance;
 volatile unsigned char rxDataBytesCounter = 0;
-volatile unsigned int distance_rx = 0, x_axis_val = 0, y_axis_val = 0;
+volatile unsigned int distance_rx = 0;
 volatile unsigned int x_axis_val_rx = 0, y_axis_val_rx = 0;
-volatile char rxBuf[25];
-volatile unsigned int distance_presets[NUM_DISTANCE_PRESETS] = { 5, 25, 50, 100, 250 }; //distances in cm
+volatile char rxBuf[RX_FRAME_LENGTH + 1];
+volatile unsigned char rx_frame_ready = 0;
+const unsigned int distance_presets[NUM_DISTANCE_PRESETS] = { 5, 25, 50, 100, 250 }; //distances in cm
 unsigned int current_distance_preset_index = 0;
 unsigned int current_distance_preset = 5;
-unsigned int adc_values[3];
-volatile unsigned char show_preset_flag,is_ready = 0;
+adc_sample_t adc_values[ADC_CHANNELS];
+mode_filters_t mode_filters;
+modes_t filters_mode; // mode mode_filters is set up for
+// reading of each accelerometer channel with the board level, by ADC_INDEX(),
+// from the information flash
+unsigned int level_values[ADC_CHANNELS];
+unsigned int preset_held_records = 0;
+volatile unsigned char is_ready = 0;
+
+// static RAM of main.c, the sampler and the display driver
+#define RAM_USED (ADC_SAMPLER_RAM + QUAD_LED_RAM \
+                  + sizeof(current_mode) + sizeof(rising_edge_value) \
+                  + sizeof(falling_edge_value) + sizeof(diff) + sizeof(i) \
+                  + sizeof(distance) + sizeof(rxDataBytesCounter) \
+                  + sizeof(distance_rx) + sizeof(x_axis_val_rx) \
+                  + sizeof(y_axis_val_rx) + sizeof(rxBuf) \
+                  + sizeof(rx_frame_ready) \
+                  + sizeof(current_distance_preset_index) \
+                  + sizeof(current_distance_preset) + sizeof(adc_values) \
+                  + sizeof(mode_filters) + sizeof(filters_mode) \
+                  + sizeof(level_values) + sizeof(preset_held_records) \
+                  + sizeof(is_ready))
+
+#ifdef __MSP430__
+// fails to compile when the static RAM leaves less than STACK_BUDGET
+typedef char ram_budget_check[(RAM_USED + STACK_BUDGET <= RAM_SIZE) ? 1 : -1];
+#endif
 
 void main(void)
 {
@@ -136,37 +210,92 @@ void main(void)
 //*******************************************************************************
 void execute_tx()
 {
+    load_level_values();
     gpio_setup_tx();
     uart_init();
     timer_setup();
-    unsigned int oldaverage_x, oldaverage_y = 0;
+    init_mode_filters(current_mode);
     __enable_interrupt();
     while (1)
     {
-        switch (current_mode)
+        // the mode button switches modes from its interrupt, the filters of
+        // the new mode start from scratch
+        const modes_t mode = current_mode;
+        if (mode != filters_mode)
+        {
+            init_mode_filters(mode);
+        }
+        switch (mode)
         {
         case DISTANCE_MEASURING_MODE:
         {
+            unsigned int lead;
             generate_trigger_signal();
             __delay_cycles(DELAY_SEC / 3); // 1/3 seconds delay
             // convert distance to cm
             distance = diff / 58;
-            // play alarm on speaker
-            buzzer_distance_mode(distance);
+            // a bad echo can make it negative, which is no distance and would
+            // show as 65535 and below in the unsigned statistics
+            if (distance >= 0)
+            {
+                channel_stats_update(&mode_filters.distance.stats, distance);
+            }
+            distance = track_filter_update(&mode_filters.distance.track,
+                                           distance);
+            // play alarm on speaker, within DISTANCE_MAX_LEAD cm at most of the
+            // preset for a moving target
+            lead = abs(track_filter_rate(&mode_filters.distance.track))
+                    / (2 * TRACK_RATE_SCALE);
+            buzzer_distance_mode(distance, (lead < DISTANCE_MAX_LEAD)
+                                 ? lead : DISTANCE_MAX_LEAD);
             serial_write("\r\n#distance:%d", distance);
+            if (mode_filters.distance.stats.count >= DISTANCE_STATS_WINDOW)
+            {
+                send_stats('d', &mode_filters.distance.stats);
+            }
             break;
         }
         case (LEVELLING_MODE):
         {
             unsigned int accl_x = 0, accl_y = 0;
-            read_adc(&accl_x, &accl_y);
-            accl_x = read_adc_running_average_filter(accl_x, oldaverage_x, 10);
-            accl_y = read_adc_running_average_filter(accl_y, oldaverage_y, 10);
-            oldaverage_x = accl_x;
-            oldaverage_y = accl_y;
-            serial_write("\r\n#level x:%d, y:%d", accl_x, accl_y);
-            if (((abs(accl_x - 490) >= 0) && (abs(accl_x - 490) <= 10))
-                    && (abs(accl_y - 490) >= 0 && abs(accl_y - 490) <= 10))
+            int level_x = 0, level_y = 0;
+            unsigned int record_x = 0, record_y = 0;
+            int pitch, roll;
+            unsigned int queued, record = 0;
+            // every sample sampled since the last pass goes through the
+            // filters, so they see them ADC_SAMPLE_RATE apart however long
+            // serial_write() took. Samples are read until a record is due
+            do
+            {
+                queued = read_adc(&accl_x, &accl_y);
+                // both decimators take the same samples, so their records
+                // are due together
+                record |= cic_filter_update(&mode_filters.level.x_decimator,
+                                            accl_x, &record_x);
+                cic_filter_update(&mode_filters.level.y_decimator, accl_y,
+                                  &record_y);
+                channel_stats_update(&mode_filters.level.x_stats, accl_x);
+                channel_stats_update(&mode_filters.level.y_stats, accl_y);
+                level_x = track_filter_update(&mode_filters.level.x_track,
+                                              accl_x);
+                level_y = track_filter_update(&mode_filters.level.y_track,
+                                              accl_y);
+            }
+            while (queued || !record);
+            // the record is sent as its angles, in tenths of a degree
+            tilt_angles((int) (record_x - level_values[ACCL_X]),
+                        (int) (record_y - level_values[ACCL_Y]),
+                        &pitch, &roll);
+            serial_write("\r\n#level x:%d, y:%d", pitch, roll);
+            if (mode_filters.level.x_stats.count >= LEVEL_STATS_WINDOW)
+            {
+                send_stats('x', &mode_filters.level.x_stats);
+                send_stats('y', &mode_filters.level.y_stats);
+            }
+            tilt_angles(level_x - (int) level_values[ACCL_X],
+                        level_y - (int) level_values[ACCL_Y],
+                        &pitch, &roll);
+            if ((abs(pitch) <= LEVEL_MAX_TILT) && (abs(roll) <= LEVEL_MAX_TILT))
             {
                 buzzer_levelling_mode();
             }
@@ -174,6 +303,16 @@ void execute_tx()
             {
                 TA0CCR0 = 0;
             }
+            // the buttons pull their pins low while pressed
+            if (P2IN & PRESET_BUTTON)
+            {
+                preset_held_records = 0;
+            }
+            else if (++preset_held_records >= CALIBRATE_HOLD_RECORDS)
+            {
+                calibrate_level();
+                preset_held_records = 0;
+            }
             break;
         }
         default:
@@ -184,9 +323,10 @@ void execute_tx()
 //******************************************************************************
 // Module execute_rx(), Last Revision date 11/16/2022, by Gandhar
 // Set of main functions for the receiver/Display chip
-// Sets up Uart and Gpio pins
+// Sets up Uart and Gpio pins, and the timer that refreshes the display
 // Enables Interrupts
-// Displays the distance that it receives
+// Puts the distance that it receives in the display framebuffer, sleeping in
+// LPM0 until the next frame arrives
 //*******************************************************************************
 void execute_rx()
 {
@@ -195,40 +335,69 @@ void execute_rx()
     uart_init();
     gpio_setup_rx();
     __enable_interrupt();
-    // show first preset distance in beginning
-   show_presets(0);
+    // show the preset distances in the beginning, until data is received
+    show_presets(0);
+    unsigned int idle_frames = 0;
     while (1)
     {
-        switch (current_mode)
+        if (rx_frame_ready)
         {
-        case DISTANCE_MEASURING_MODE:
-        {
-//            if(show_preset_flag)
-//            {
-//                show_presets(0);
-//                show_preset_flag = 0;
-//            }
-            if(is_ready)
+            unsigned int old_distance = distance_rx;
+            unsigned int old_x = x_axis_val_rx, old_y = y_axis_val_rx;
+            parse_rx_frame();
+            // dim the display to save power while the reading does not change
+            if (distance_rx == old_distance && x_axis_val_rx == old_x
+                    && y_axis_val_rx == old_y)
             {
-                display_digits(distance_rx);
+                if (idle_frames < IDLE_RX_FRAMES)
+                {
+                    idle_frames++;
+                }
+                else
+                {
+                    quad_led_set_brightness(IDLE_BRIGHTNESS);
+                }
             }
-            break;
-        }
-        case LEVELLING_MODE:
-        {
-            if(is_ready)
+            else
             {
-                display_axis_info(abs(x_axis_val_rx-490), abs(y_axis_val_rx-490));
+                idle_frames = 0;
+                quad_led_set_brightness(QUAD_LED_BRIGHTNESS_MAX);
+            }
+            switch (current_mode)
+            {
+            case DISTANCE_MEASURING_MODE:
+            {
+                if (is_ready)
+                {
+                    // sent with %d, a bad echo can make it negative, which
+                    // is shown with its sign rather than a blank display
+                    quad_led_show_signed((int) distance_rx);
+                }
+                break;
+            }
+            case LEVELLING_MODE:
+            {
+                if (is_ready)
+                {
+                    // signed so the display shows which way the board tilts,
+                    // received in tenths of a degree and shown in degrees
+                    display_axis_info((int) x_axis_val_rx / 10,
+                                      (int) y_axis_val_rx / 10);
+                }
+                break;
+            }
+            default:
+                break;
             }
-//            display_axis_info(45, 90);
-//            display_digits(abs(x_axis_val-490));
-//            __delay_cycles(DELAY_SEC*3);
-//            display_digits(abs(y_axis_val-490));
-            break;
         }
-        default:
-            break;
+        // sleep until the next frame is received, the flag is checked with
+        // interrupts off so a frame completing in between is not missed
+        __disable_interrupt();
+        if (!rx_frame_ready)
+        {
+            __bis_SR_register(LPM0_bits + GIE);
         }
+        __enable_interrupt();
     }
 }
 //******************************************************************************
@@ -251,19 +420,15 @@ void gpio_setup_tx(void)
 
 //******************************************************************************
 // Module gpio_setup_tx(), Last Revision date 11/16/2022, by Gandhar
-// Sets up GPIO pins for Rx pin as defined at beginning of program
+// Sets up GPIO pins for Rx pin, with the display pins defined in led_pins.h
 // As initializes UART Pin Interrupt
 //*******************************************************************************
 void gpio_setup_rx(void)
 {
-    P2DIR |= DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4 + a;
-    P1DIR |= b + c + d + e + f + g;
     P1SEL = TX_PIN | RX_PIN;
     P1SEL2 = TX_PIN | RX_PIN;
-    P2SEL &= ~BIT6;                                    // enable p2.6 as gpio
-    P2SEL &= ~BIT7;                                    // enable p2.7 as gpio
-    P2OUT &= ~(DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4); // all digits off by default
-    UC0IE |= UCA0RXIE;                            // Enable USCI_A0 RX interrupt
+    quad_led_init();           // display pins as in led_pins.h, all digits off
+    UC0IE |= UCA0RXIE;         // Enable USCI_A0 RX interrupt
 }
 
 //******************************************************************************
@@ -362,10 +527,6 @@ __interrupt void button_interrupt(void)
         current_mode =
                 (current_mode == DISTANCE_MEASURING_MODE) ?
                         LEVELLING_MODE : DISTANCE_MEASURING_MODE;
-//        if(current_mode == DISTANCE_MEASURING_MODE)
-//        {
-//            show_preset_flag = 1;
-//        }
         break;
     }
     default:
@@ -378,49 +539,26 @@ __interrupt void button_interrupt(void)
 
 //******************************************************************************
 // Module Function configure_adc(), Last Revision date 9/13/2022, by Owen
-// function for initializing ADC
+// function for initializing ADC, the accelerometer channels are sampled
+// ADC_SAMPLE_RATE times a second from then on
 //*******************************************************************************
 void configure_adc()
 {
-
-//    ADC10CTL1 = INCH_3 + ADC10DIV_3; // Channel 7, ADC10CLK/3
-    ADC10CTL0 = SREF_0 + ADC10SHT_3 + ADC10ON; // Vcc & Vss as reference,
-    //Sample and hold for 64 Clock cycles, ADC on, ADC interrupt enable
-//    ADC10AE0 |= ACCL_INPUT_Y; // set p1.7 as adc input pin
+    adc_sampler_init(); // channels and pins as in adc_pins.h
 }
 
 //******************************************************************************
 // Module Function read_adc(), Last Revision date 9/13/2022, by Owen
-// Reads ADC_INPUT of ADC and Returns the digital Value as an integer
-//*******************************************************************************
-void read_adc(unsigned int *x_axis, unsigned int *y_axis)
-{
-    ADC10CTL1 = ADC10DIV_3 + INCH_3; // Channel 3, ADC10CLK/3
-    ADC10AE0 = ACCL_INPUT_X;
-    while (ADC10CTL1 & ADC10BUSY)
-        ;
-    ADC10CTL0 |= ENC + ADC10SC; // Sampling and conversion start
-    *x_axis = ADC10MEM;         // read x_axis value from ADC
-    __delay_cycles(100);
-    ADC10CTL1 = ADC10DIV_3 + INCH_4; // channel 4
-    ADC10AE0 = ACCL_INPUT_Y;
-    while (ADC10CTL1 & ADC10BUSY)
-        ;
-    ADC10CTL0 |= ENC + ADC10SC; // Sampling and conversion start
-    *y_axis = ADC10MEM;         // read y_axis value from ADC
-}
-
-//******************************************************************************
-//Module Function read_adc_running_average_filter(), Last Revision date 9/22/2022, by Owen
-//Taking the old average, and the weight, which is set above, calculates the new running average
-//The higher the weight, the more oscillations are damped down
+// Reads the x and y axis of the accelerometer from the oldest sequence not read
+// yet, so both axes are from the same sequence, and returns how many sequences
+// are left to read
 //*******************************************************************************
-unsigned int read_adc_running_average_filter(unsigned int raw_adc_val,
-                                             unsigned int oldaverage,
-                                             unsigned int weight)
+unsigned int read_adc(unsigned int *x_axis, unsigned int *y_axis)
 {
-    unsigned int average = (oldaverage * weight + raw_adc_val) / (weight + 1); //Simple running average formula
-    return average;
+    unsigned int queued = adc_sampler_next(adc_values);
+    *x_axis = adc_values[ACCL_X].value; // x_axis value from ADC
+    *y_axis = adc_values[ACCL_Y].value; // y_axis value from ADC
+    return queued;
 }
 
 void update_distance_preset()
@@ -456,10 +594,25 @@ void serial_write(const char *fmt, ...)
     }
 }
 
+//******************************************************************************
+// Module Function send_stats()
+// Sends the min, max, mean and variance of the raw readings of a channel since
+// its last summary, and starts a new window. At least 32 characters, so the Rx
+// chip takes it as one whole frame it does not know and skips it
+//*******************************************************************************
+void send_stats(char channel, channel_stats_t *stats)
+{
+    serial_write("\r\n#stats %c %4u %4u %4u %6lu", channel, stats->min,
+                 stats->max, channel_stats_mean(stats),
+                 channel_stats_variance(stats));
+    channel_stats_reset(stats);
+}
+
 //******************************************************************************
 // interrupt serial_rx_interrupt, Last Revision date 11/8/2022, by Gandhar
-// When a chip configured to listen to UART recieves data, extracts the
-// Integer from the data stream, and writes it to the global variable adcValue
+// When a chip configured to listen to UART recieves data, collects a frame of
+// RX_FRAME_LENGTH bytes starting at '\r' and wakes up the main loop to parse it
+// Bytes received before the main loop has parsed the frame are dropped
 //*******************************************************************************
 #pragma vector = USCIAB0RX_VECTOR
 __interrupt void serial_rx_interrupt(void)
@@ -471,27 +624,15 @@ __interrupt void serial_rx_interrupt(void)
         {
             rxBuf[rxDataBytesCounter++] = UCA0RXBUF;
         }
-        else if (rxDataBytesCounter > 0 && rxDataBytesCounter < 25)
+        else if (rxDataBytesCounter > 0 && rxDataBytesCounter < RX_FRAME_LENGTH)
         {
             rxBuf[rxDataBytesCounter++] = UCA0RXBUF;
-        }
-        else if (rxDataBytesCounter >= 25)
-        {
-            if (sscanf(rxBuf, "\r\n#distance:%d", &distance_rx))
-            {
-                current_mode = DISTANCE_MEASURING_MODE;
-            }
-            else if (sscanf(rxBuf, "\r\n#level x:%d, y:%d", &x_axis_val_rx,
-                            &y_axis_val_rx))
+            if (rxDataBytesCounter == RX_FRAME_LENGTH)
             {
-                current_mode = LEVELLING_MODE;
+                // frame complete, wake up the main loop to parse it
+                rx_frame_ready = 1;
+                __bic_SR_register_on_exit(LPM0_bits);
             }
-            is_ready = 1;
-//            else if (sscanf(rxBuf, "\r\n#preset:%d",&distance_rx))
-//            {
-//                show_preset_flag = 1;
-//            }
-            rxDataBytesCounter = 0;
         }
         IFG2 &= ~UCA0RXIFG;
         __enable_interrupt();
@@ -499,361 +640,171 @@ __interrupt void serial_rx_interrupt(void)
 }
 
 //******************************************************************************
-// Module Function led_display_num(), Last Revision date 9/22/2022, by Gandhar
-// Taking in a value, lights all of the segments required so that the value can be
-// displayed
-// Requires that the correct pins be declared on the top
+// Module Function parse_rx_frame()
+// Extracts the distance or the axis values from the frame collected by
+// serial_rx_interrupt, then lets the interrupt start collecting the next one
 //*******************************************************************************
-void led_display_num(const unsigned val)
+void parse_rx_frame(void)
 {
-    // turn off all segments first
-    P1OUT |= b + c + d + e + f + g;
-    P2OUT |= a;
-    // For each number, light the needed segments
-    // using program lit_let_segment
-    switch (val)
-    {
-    case 0:
+    if (sscanf(rxBuf, "\r\n#distance:%d", &distance_rx))
     {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        break;
-    }
-    case 1:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-    case 2:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
+        current_mode = DISTANCE_MEASURING_MODE;
     }
-    case 3:
+    else if (sscanf(rxBuf, "\r\n#level x:%d, y:%d", &x_axis_val_rx,
+                    &y_axis_val_rx))
     {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 4:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 5:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 6:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 7:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-    case 8:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 9:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    default:
-        lit_led_segment(G_SEGMENT);
-        break;
+        current_mode = LEVELLING_MODE;
     }
+    is_ready = 1;
+    rx_frame_ready = 0;
+    rxDataBytesCounter = 0;
 }
 
 //******************************************************************************
-// Module Function lit_let_segment(), Last Revision date 9/22/2022, by Gandhar
-// Given a segment, turn it on.
+// Module Function show_presets()
+// Starts showing the distance presets one after the other from the display
+// refresh interrupt, and returns at once so received data is shown as soon as
+// it arrives
 //*******************************************************************************
-void lit_led_segment(LED_SEGMENTS segment)
+void show_presets(unsigned int preset_distance)
 {
-    switch (segment)
-    {
-    case A_SEGMENT:
-    {
-        P2OUT &= ~a;
-        break;
-    }
-    case B_SEGMENT:
-    {
-        P1OUT &= ~b;
-        break;
-    }
-    case C_SEGMENT:
-    {
-        P1OUT &= ~c;
-        break;
-    }
-    case D_SEGMENT:
-    {
-        P1OUT &= ~d;
-        break;
-    }
-    case E_SEGMENT:
-    {
-        P1OUT &= ~e;
-        break;
-    }
-    case F_SEGMENT:
-    {
-        P1OUT &= ~f;
-        break;
-    }
-    case G_SEGMENT:
-    {
-        P1OUT &= ~g;
-        break;
-    }
-    default:
-        break;
-    }
+    quad_led_play_numbers(&distance_presets[preset_distance],
+                          NUM_DISTANCE_PRESETS - preset_distance,
+                          PRESET_SHOW_FRAMES);
 }
 
-void display_num_cont(unsigned int num,unsigned int delay)
+//******************************************************************************
+// Module Function tilt_angles()
+// Given the x and y accelerometer readings less their level value, works out
+// the pitch and roll of the board in tenths of a degree. The z axis is not
+// wired, it is taken from the length of g with the board the right way up
+//*******************************************************************************
+void tilt_angles(int x, int y, int *pitch, int *roll)
 {
-    for(i=0;i<delay;i++)
+    const unsigned long g_squared = (unsigned long) LEVEL_COUNTS_PER_G
+            * LEVEL_COUNTS_PER_G;
+    unsigned long xy_squared = (long) x * x + (long) y * y;
+    unsigned int z = 0, yz;
+
+    if (xy_squared < g_squared)
     {
-        int j=0;
-        for(j=0;j<delay;j++)
-        {
-            display_digits(num);
-        }
+        z = cordic_sqrt(g_squared - xy_squared);
     }
+    // roll turns y about x towards z, pitch turns x towards the y-z plane
+    *roll = cordic_atan2(y, z, &yz);
+    *pitch = cordic_atan2(x, yz, 0);
 }
 
-void show_presets(unsigned int preset_distance)
+//******************************************************************************
+// Module Function load_level_values()
+// Takes the level readings calibrate_level() keeps in the information flash,
+// or LEVEL_ADC_VALUE for both axes when the board has not been calibrated yet
+//*******************************************************************************
+void load_level_values(void)
 {
-    volatile unsigned int j=0;
-    while(1)
+    if (!info_flash_load(level_values, ADC_CHANNELS))
     {
-        unsigned int i = 0;
-        if(j == 5) return;
-        switch(j)
-        {
-            case 0: display_num_cont(5,300);
-                    break;
-            case 1: display_num_cont(25,300);
-                    break;
-            case 2: display_num_cont(50,300);
-                    break;
-            case 3: display_num_cont(100,300);
-                    break;
-            case 4: display_num_cont(250,300);
-                    break;
-            default: break;
-        }
-
-
-        j++;
+        level_values[ACCL_X] = LEVEL_ADC_VALUE;
+        level_values[ACCL_Y] = LEVEL_ADC_VALUE;
     }
 }
 
 //******************************************************************************
-// Module Function display_digits(), Last Revision date 9/22/2022, by Gandhar
-// Given a number to display, turns on the digits in display that need to be turned
-// on
-// Then displays the digit, delaying an amount of time set in macros to improve
-// persistence of vision
+// Module Function init_mode_filters()
+// Sets up the filters of a mode from scratch in mode_filters, which both modes
+// share, and records which mode they are set up for
 //*******************************************************************************
-void display_digits(unsigned int val)
+void init_mode_filters(modes_t mode)
 {
-    unsigned int digit = 0;
-    unsigned int number = val;
-    if (val >= 0 && val <= 9)
-    {
-        // If the number is less than 10, turn on
-        // first digit and display the value
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (val >= 10 && val <= 99)
-    {
-        // If the number is more than 10, but less than 99
-        // Turn on 1s place digit, display value, and delay
-        // Then extract 10s place digit and repeat
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        digit = (number / 10) % 10;
-        __delay_cycles(DIGDELAY);
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (val >= 100 && val <= 999)
-    {
-        // If the number is more than 10, but less than 99
-        // Turn on 1s place digit, display value, and delay
-        // Then extract 10s place digit and repeat
-        // Then extract 1000s place digit and repeat again
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
+    if (mode == LEVELLING_MODE)
+    {
+        track_filter_init(&mode_filters.level.x_track, LEVEL_ALPHA_SHIFT,
+                          LEVEL_BETA_SHIFT, LEVEL_GATE);
+        track_filter_init(&mode_filters.level.y_track, LEVEL_ALPHA_SHIFT,
+                          LEVEL_BETA_SHIFT, LEVEL_GATE);
+        cic_filter_init(&mode_filters.level.x_decimator, LEVEL_RECORD_ORDER,
+                        LEVEL_RECORD_SHIFT);
+        cic_filter_init(&mode_filters.level.y_decimator, LEVEL_RECORD_ORDER,
+                        LEVEL_RECORD_SHIFT);
+        channel_stats_reset(&mode_filters.level.x_stats);
+        channel_stats_reset(&mode_filters.level.y_stats);
     }
-    else if (val >= 1000 && val <= 9999)
+    else
     {
-        // Do the same process as above, but for all 4 digits.
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 1000) % 10;
-        P2OUT = DIGIT_1;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
+        track_filter_init(&mode_filters.distance.track, DISTANCE_ALPHA_SHIFT,
+                          DISTANCE_BETA_SHIFT, DISTANCE_GATE);
+        channel_stats_reset(&mode_filters.distance.stats);
     }
+    filters_mode = mode;
 }
 
-void display_axis_info(unsigned int x_axis_val, unsigned int y_axis_val)
+//******************************************************************************
+// Module Function calibrate_level()
+// Once PRESET_BUTTON is let go, averages the readings of the board at rest on
+// a level surface, makes them the level readings and keeps them in the
+// information flash for the next boot
+//*******************************************************************************
+void calibrate_level(void)
 {
-    if (x_axis_val == 0)
-    {
-        P2OUT = DIGIT_2;
-        led_display_num(0);
-        __delay_cycles(DIGDELAY);
-    }
-    if (y_axis_val == 0)
-    {
-        P2OUT = DIGIT_4;
-        led_display_num(0);
-        __delay_cycles(DIGDELAY);
-    }
-
-    if (y_axis_val <= 9)
-    {
-        // If the number is less than 10, turn on
-        // first digit and display the value
-        P2OUT = DIGIT_4;
-        led_display_num(y_axis_val);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (y_axis_val >= 10 && y_axis_val <= 99)
-    {
-        P2OUT = DIGIT_4;
-        led_display_num(y_axis_val % 10);
-        __delay_cycles(DIGDELAY);
-        P2OUT = DIGIT_3;
-        led_display_num((y_axis_val / 10) % 10);
-        __delay_cycles(DIGDELAY);
-    }
+    TA0CCR0 = 0; // buzzer off while the board is kept still
+    while (!(P2IN & PRESET_BUTTON))
+        ;
+    adc_sampler_average(level_values);
+    info_flash_store(level_values, ADC_CHANNELS);
+}
 
-    if (x_axis_val <= 9)
-    {
-        // If the number is less than 10, turn on
-        // first digit and display the value
-        P2OUT = DIGIT_2;
-        led_display_num(x_axis_val);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (x_axis_val >= 10 && x_axis_val <= 99)
-    {
-        P2OUT = DIGIT_2;
-        led_display_num(x_axis_val % 10);
-        __delay_cycles(DIGDELAY);
-        P2OUT = DIGIT_1;
-        led_display_num((x_axis_val / 10) % 10);
-        __delay_cycles(DIGDELAY);
-    }
+//******************************************************************************
+// Module Function display_axis_info()
+// Puts the x axis tilt on digits 1-2 and the y axis tilt on digits 3-4 of the
+// framebuffer, from -9 to 99. A tilt that does not fit shows "--"
+//*******************************************************************************
+void display_axis_info(int x_axis_val, int y_axis_val)
+{
+    static const led_field_t axis_layout[] = {
+        { FIELD_NUMBER, 0, 2, 0 }, // x axis
+        { FIELD_NUMBER, 2, 2, 0 }  // y axis
+    };
+    const int values[] = { x_axis_val, y_axis_val };
+    quad_led_show_fields(axis_layout, values, 2);
 }
 
 //******************************************************************************
 // Module Function void buzzer_distance_mode(unsigned int cm),
 // Last Revision date 11/16/2022, by Owen
-// Given a distance in cm, activates the buzzer_distance_mode with a certain pitch.
+// Given a distance in cm, activates the buzzer_distance_mode with a certain pitch
+// when the distance is within tolerance cm of the preset.
 // Lower distances have higher pitches
 //********************************************************************************
-void buzzer_distance_mode(const unsigned int cm)
+void buzzer_distance_mode(const unsigned int cm, unsigned int tolerance)
 {
-    if (cm == 5 && current_distance_preset == 5)
+    unsigned int reached = (unsigned int) abs((int) cm
+            - (int) current_distance_preset) <= tolerance;
+
+    if (reached && current_distance_preset == 5)
     {
         // Set the period in the Timer A0
         // To 300.
         TA0CCR0 = 300;
     }
-    else if ((cm == 25) && (current_distance_preset == 25))
+    else if (reached && (current_distance_preset == 25))
     {
         // Set the period in the Timer A0
         // To 600.
         TA0CCR0 = 600;
     }
-    else if ((cm == 50) && (current_distance_preset == 50))
+    else if (reached && (current_distance_preset == 50))
     {
         // Set the period in the Timer A0
         // To 1250.
         TA0CCR0 = 1250;
     }
-    else if ((cm == 100) && (current_distance_preset == 100))
+    else if (reached && (current_distance_preset == 100))
     {
         // Set the period in the Timer A0
         // To 2500.
         TA0CCR0 = 2500;
     }
-    else if ((cm == 250) && (current_distance_preset == 250))
+    else if (reached && (current_distance_preset == 250))
     {
         // Set the period in the Timer A0
         // To 20000.
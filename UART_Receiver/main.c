@@ -7,23 +7,7 @@
 
 #include <msp430.h>
 #include <stdio.h>
-
-// PORT2 pins for turning on LED digits
-#define DIGIT_1 BIT3  //p2.3
-#define DIGIT_2 BIT2  //p2.2
-#define DIGIT_3 BIT1  //p2.1
-#define DIGIT_4 BIT0  //p2.0
-
-// 7 segments B-F of LED connected to pins of port1 and  A to port2
-#define a BIT4    //p2.4
-#define b BIT5    //p1.5
-#define c BIT0    //p1.0
-#define d BIT3    //p1.3
-#define e BIT7    //p1.7
-#define f BIT6    //p1.6
-#define g BIT4    //p1.4
-
-#define DIGDELAY 2000 // Number of cycles to delay for displaying each digit in display_digits
+#include "../Common/quad_led.h"
 
 //#define RXLED BIT6
 #define RX_DATA_LENGTH 6
@@ -34,17 +18,6 @@ volatile unsigned char rxDataBytesCounter = 0;
 volatile unsigned int adcValue;
 volatile char testBuf[25];
 
-typedef enum
-{
-    A_SEGMENT = 0,
-    B_SEGMENT,
-    C_SEGMENT,
-    D_SEGMENT,
-    E_SEGMENT,
-    F_SEGMENT,
-    G_SEGMENT,
-} LED_SEGMENTS;
-
 //#pragma pack(1)
 //
 //typedef union
@@ -67,16 +40,6 @@ typedef enum
 
 unsigned char rxBuf[RX_DATA_LENGTH];
 
-void led_display_num(const unsigned val);
-
-//******************************************************************************
-// Module Function lit_let_segment(), Last Revision date 9/22/2022, by Gandhar
-// Given a segment, turn it on.
-//*******************************************************************************
-void lit_led_segment(LED_SEGMENTS segment);
-
-void display_digits(const unsigned int val);
-
 void uart_init();
 
 void ser_output(char *str);
@@ -90,15 +53,9 @@ void main(void)
     BCSCTL1 = CALBC1_1MHZ;
     DCOCTL = CALDCO_1MHZ;
 
-    P2DIR |= DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4 + a;
-    P1DIR |= b + c + d + e + f + g;
-
-    P2SEL &= ~BIT6;  //enable p2.6 as gpio
-    P2SEL &= ~BIT7;  //enable p2.7 as gpio
-
 //    P1DIR |= RXLED;
 
-    P2OUT &= ~(DIGIT_1 + DIGIT_2 + DIGIT_3 + DIGIT_4); // all digits off by default
+    quad_led_init(); // display pins as in led_pins.h, all digits off by default
     uart_init();
     UC0IE |= UCA0RXIE; // Enable USCI_A0 RX interrupt
     __enable_interrupt();
@@ -106,7 +63,7 @@ void main(void)
     {
 //        adcValue = 0;
 
-          display_digits(adcValue);
+          quad_led_show_number(adcValue);
 
 //         char buf[25] = {0};
 //        if (rxDataBytesCounter == 25)
@@ -208,233 +165,3 @@ __interrupt void serial_rx_interrupt(void)
         __enable_interrupt();
     }
 }
-
-//******************************************************************************
-// Module Function led_display_num(), Last Revision date 9/22/2022, by Gandhar
-// Taking in a value, lights all of the segments required so that the value can be displayed
-// Requires that the correct pins be declared on the top
-//*******************************************************************************
-void led_display_num(const unsigned val)
-{
-    // turn off all segments first
-    P1OUT |= b + c + d + e + f + g;
-    P2OUT |= a;
-    // For each number, light the needed segments using program lit_let_segment
-    switch (val)
-    {
-    case 0:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        break;
-    }
-    case 1:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-    case 2:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 3:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 4:
-    {
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 5:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 6:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 7:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        break;
-    }
-
-    case 8:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(D_SEGMENT);
-        lit_led_segment(E_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    case 9:
-    {
-        lit_led_segment(A_SEGMENT);
-        lit_led_segment(B_SEGMENT);
-        lit_led_segment(C_SEGMENT);
-        lit_led_segment(F_SEGMENT);
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-    default:
-        lit_led_segment(G_SEGMENT);
-        break;
-    }
-}
-
-//******************************************************************************
-// Module Function lit_let_segment(), Last Revision date 9/22/2022, by Gandhar
-// Given a segment, turn it on.
-//*******************************************************************************
-void lit_led_segment(LED_SEGMENTS segment)
-{
-    switch (segment)
-    {
-    case A_SEGMENT:
-    {
-        P2OUT &= ~a;
-        break;
-    }
-    case B_SEGMENT:
-    {
-        P1OUT &= ~b;
-        break;
-    }
-    case C_SEGMENT:
-    {
-        P1OUT &= ~c;
-        break;
-    }
-    case D_SEGMENT:
-    {
-        P1OUT &= ~d;
-        break;
-    }
-    case E_SEGMENT:
-    {
-        P1OUT &= ~e;
-        break;
-    }
-    case F_SEGMENT:
-    {
-        P1OUT &= ~f;
-        break;
-    }
-    case G_SEGMENT:
-    {
-        P1OUT &= ~g;
-        break;
-    }
-    default:
-        break;
-    }
-}
-
-//******************************************************************************
-// Module Function display_digits(), Last Revision date 9/22/2022, by Gandhar
-// Given a number to display, turns on the digits in display that need to be turned on
-// Then displays the digit, delaying an amount of time set in macros to improve persistence of vision
-//*******************************************************************************
-void display_digits(const unsigned int val)
-{
-
-    unsigned int digit = 0;
-    unsigned int number = val;
-    volatile unsigned int i;
-
-    if (val >= 0 && val <= 9)
-    {
-        // If the number is less than 10, turn on first digit and display the value
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-    }
-    else if (val >= 10 && val <= 99)
-    {
-        // If the number is more than 10, but less than 99
-        // Turn on 1s place digit, display value, and delay
-        // Then extract 10s place digit and repeat
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        digit = (number / 10) % 10;
-        __delay_cycles(DIGDELAY);
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (val >= 100 && val <= 999)
-    {
-        // If the number is more than 10, but less than 99
-        // Turn on 1s place digit, display value, and delay
-        // Then extract 10s place digit and repeat
-        // Then extract 1000s place digit and repeat again
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-    }
-    else if (val >= 1000 && val <= 9999)
-    {
-        // Do the same process as above, but for all 4 digits.
-        digit = number % 10;
-        P2OUT = DIGIT_4;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 10) % 10;
-        P2OUT = DIGIT_3;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 100) % 10;
-        P2OUT = DIGIT_2;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-        digit = (number / 1000) % 10;
-        P2OUT = DIGIT_1;
-        led_display_num(digit);
-        __delay_cycles(DIGDELAY);
-    }
-}
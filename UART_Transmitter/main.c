@@ -8,11 +8,30 @@
 #include <msp430.h>
 #include <string.h>
 #include <stdio.h>
+#include "../Common/adc_sampler.h"
+#include "../Common/filters.h"
 
-#define ADC_INPUT BIT3 //p1.7 for ADC
+#define ADC_CHANNEL 3 //p1.3 for ADC, the pin is in adc_pins.h
 
 #define TXLED BIT0
 
+#define SPIKE_NUMS 5 // readings the median is taken of, 3 or 5
+#define POT_EMA_SHIFT 2 // average of about 4 medians
+#define SEND_BAND 2 // change needed before a new value is sent
+
+// median of the last SPIKE_NUMS readings, averaged, then only passed on when
+// it moves SEND_BAND or more, so the serial line is quiet while the pot is still
+spike_filter_t adc_spikes;
+ema_filter_t adc_average;
+deadband_filter_t adc_deadband;
+
+const filter_stage_t pot_filter[] =
+{
+    { FILTER_SPIKE, &adc_spikes },
+    { FILTER_EMA, &adc_average },
+    { FILTER_DEADBAND, &adc_deadband }
+};
+
 //#pragma pack(1)
 
 //typedef union
@@ -43,26 +62,6 @@ void configureAdc();
 //Reads ADC_INPUT of ADC and Returns the digital Value as an integer
 //*******************************************************************************
 unsigned int read_adc();
-//******************************************************************************
-//Module Function read_adc_mean_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the unweighted average
-//Ultimately not used do to combination of time and oscillation
-//*******************************************************************************
-unsigned int read_adc_mean_filtered(volatile unsigned int number);
-
-//******************************************************************************
-//Module Function read_adc_median_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the median of them
-//Ultimately not used do to combination of time and oscillation
-//*******************************************************************************
-unsigned int read_adc_median_filtered(volatile unsigned int number);
-
-//******************************************************************************
-//Module Function read_adc_running_average_filter(), Last Revision date 9/22/2022, by Owen
-//Taking the old average, and the weight, which is set above, calculates the new running average
-//The higher the weight, the more oscillations are damped down
-//*******************************************************************************
-unsigned int read_adc_running_average_filter(unsigned int oldaverage, unsigned int weight);
 
 
 void uart_init();
@@ -104,19 +103,23 @@ void main(void)
     P1DIR |=  TXLED;
 
     configureAdc();
+    spike_filter_init(&adc_spikes, SPIKE_NUMS);
+    ema_filter_init(&adc_average, POT_EMA_SHIFT);
+    deadband_filter_init(&adc_deadband, SEND_BAND);
     uart_init();
 
-    unsigned int old_adc_val = 0;
+    unsigned int old_adc_val = ~0; // the first value is always sent
 
     while (1)
     {
 //         char txbuf[25];
 
-//        unsigned int adc_val = read_adc_median_filtered();
 //        ser_output("\r\n\nADC val:");
-        unsigned int new_adc_val = read_adc();
+        unsigned int new_adc_val = filter_pipeline_update(pot_filter,
+                                                          FILTER_STAGES(pot_filter),
+                                                          read_adc());
 
-        if((new_adc_val-old_adc_val>1) || (old_adc_val-new_adc_val > 1))
+        if(new_adc_val != old_adc_val)
         {
             send_data(new_adc_val);
             old_adc_val = new_adc_val;
@@ -126,9 +129,7 @@ void main(void)
 //        ltoa(adc_val,txbuf,10);
 //         ser_output(txbuf);
 
-//        adc_val = read_adc_running_average_filter(oldaverage, 10);
 //        display_digits(adc_val);
-//        oldaverage = adc_val;
 //        __delay_cycles(10000);
     }
 }
@@ -161,9 +162,7 @@ void ser_output(unsigned char *str){
 //*******************************************************************************
 void configureAdc()
 {
-    ADC10CTL1 = INCH_3 + ADC10DIV_3;         // Channel 7, ADC10CLK/3
-    ADC10CTL0 = SREF_0 + ADC10SHT_3 + ADC10ON + ADC10IE; // Vcc & Vss as reference, Sample and hold for 64 Clock cycles, ADC on, ADC interrupt enable
-    ADC10AE0 |= ADC_INPUT;                         // set p1.7 as adc input pin
+    ADC10AE0 |= ADC_INPUTS;    // set p1.3 as adc input pin, conversions are polled
 }
 
 //******************************************************************************
@@ -172,62 +171,7 @@ void configureAdc()
 //*******************************************************************************
 unsigned int read_adc()
 {
-    while (ADC10CTL1 & ADC10BUSY)
-        ;
-    ADC10CTL0 |= ENC + ADC10SC;         // Sampling and conversion start
-    unsigned int ADC_value = ADC10MEM; // Assigns the value held in ADC10MEM to the integer called ADC_value
-    return ADC_value;
-}
-//******************************************************************************
-//Module Function read_adc_mean_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the unweighted average
-//Ultimately not used do to combination of time and oscillation
-//*******************************************************************************
-unsigned int read_adc_mean_filtered(volatile unsigned int number) {
-    unsigned int values = 0;
-    volatile unsigned int i;
-    for(i = number; i > 0; i--) {
-        values += read_adc();
-    }
-    return values / number;
+    adc_sample_t sample;
+    adc_sampler_read(ADC_CHANNEL, &sample); // returns once the conversion is done
+    return sample.value;
 }
-
-//******************************************************************************
-//Module Function read_adc_median_filtered(), Last Revision date 9/22/2022, by Owen
-//Given a number, reads the ADC a certain number of times, and returns the median of them
-//Ultimately not used do to combination of time and oscillation
-//*******************************************************************************
-unsigned int read_adc_median_filtered(volatile unsigned int number)
-{
-    unsigned int arr[number];
-    volatile unsigned int i,j,tmp;
-
-    for(i = number; i > 0; i--) { //reads ADC certain number of times
-        arr[i] = read_adc();
-    }
-
-    for(i=0;i<number;i++) //Algorithm taken from robotics class last semester
-    {                     //Sorts the array by size
-        for(j=0; j < number; j++)
-        {
-            if(arr[j] > arr[i]) {
-                tmp = arr[i];
-                arr[i] = arr[j];
-                arr[j] = tmp;
-            }
-        }
-    }
-    return arr[number / 2]; //returns the middle value in the array, which is the Median
-}
-//******************************************************************************
-//Module Function read_adc_running_average_filter(), Last Revision date 9/22/2022, by Owen
-//Taking the old average, and the weight, which is set above, calculates the new running average
-//The higher the weight, the more oscillations are damped down
-//*******************************************************************************
-unsigned int read_adc_running_average_filter(unsigned int oldaverage, unsigned int weight) {
-    unsigned int average;
-    unsigned int value = read_adc();
-    average =  (oldaverage * weight + value)/(weight + 1); //Simple running average formula
-    return average;
-}
-
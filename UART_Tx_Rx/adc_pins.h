@@ -0,0 +1,18 @@
+/*
+ *  adc_pins.h
+ *  ADC10 channels of the pot transmitter
+ *  Used by Common/adc_read.c
+ */
+
+#ifndef ADC_PINS_H_
+#define ADC_PINS_H_
+
+// channels A0 up to this one are converted in every sequence
+#define ADC_HIGHEST_CHANNEL 3
+
+// pins of port 1 used as analog inputs
+#define ADC_INPUTS BIT3 // p1.3, the pot
+
+// no ADC_TIME, nothing uses the timestamps of the single conversions
+
+#endif /* ADC_PINS_H_ */